@@ -90,12 +90,24 @@
  *----------------------------------------------------------*/
 
 #define configUSE_PREEMPTION			1
+/* 1 - pomiar czasu procesora zwalnianego przez sterownik 1-Wire (vApplicationIdleHook
+   w test_app_m32.c), wymaga SPI1WIRE_USE_FREERTOS == 1 */
 #define configUSE_IDLE_HOOK				0
+/* 1 - pomiar opnienia obsugi taktu systemu (vApplicationTickHook w test_app_m32.c),
+   np. do porwnania SPI1WIRE_NESTED_ISR = 0 i 1 */
 #define configUSE_TICK_HOOK				0
 #define configCPU_CLOCK_HZ				( ( unsigned long ) 14745600 )
 #define configTICK_RATE_HZ				( ( portTickType ) 1000 )
 #define configMAX_PRIORITIES			( ( unsigned portBASE_TYPE ) 2 )
-#define configMINIMAL_STACK_SIZE		( ( unsigned short ) 85 )
+/* SPI1WIRE_NESTED_ISR = 1 (spi1wire.h) - stos kadego zadania mieci dodatkowo
+   ramk przerwania od SPI i zagniedonego w nim przerwania; warto bez
+   rzutowania (configMINIMAL_STACK_DEPTH) sprawdzana jest w spi1wire.c */
+#if defined(SPI1WIRE_NESTED_ISR) && SPI1WIRE_NESTED_ISR
+#define configMINIMAL_STACK_DEPTH		125
+#else
+#define configMINIMAL_STACK_DEPTH		85
+#endif
+#define configMINIMAL_STACK_SIZE		( ( unsigned short ) configMINIMAL_STACK_DEPTH )
 #define configTOTAL_HEAP_SIZE			( (size_t ) ( 1500 ) )
 #define configMAX_TASK_NAME_LEN			( 5 )
 #define configUSE_TRACE_FACILITY		0
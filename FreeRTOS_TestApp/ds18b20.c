@@ -0,0 +1,109 @@
+/** @file ds18b20.c
+  */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "ds18b20.h"
+#include "onewire_crc.h"
+
+/**
+  * Wybr czujnika: RESET-PULSE-PRESENCE oraz MatchROM z identyfikatorem lub
+  * SkipROM, a nastpnie rozkaz funkcji ukadu
+  *
+  * @return 0 - brak odpowiedzi ukadw SLAVE, w przeciwnym razie warto rna od zera
+  */
+static uint8_t DS18B20_Select(const DS18B20_Bus *bus, const uint8_t *rom, uint8_t command)
+{
+	uint8_t frame[1 + DS18B20_ROM_SIZE + 1];
+	uint8_t length = 0;
+
+	if (bus->pxResetPresence() == 0) return 0;
+	if (rom != NULL)
+	{
+		frame[length++] = cmd_DS18x20_MatchROM;
+		memcpy(&frame[length], rom, DS18B20_ROM_SIZE);
+		length += DS18B20_ROM_SIZE;
+	}
+	else frame[length++] = cmd_DS18x20_SkipROM;
+	frame[length++] = command;
+	bus->pxWriteBlock(frame, length);
+	return 1;
+}
+
+uint8_t DS18B20_ReadScratchpad(const DS18B20_Bus *bus, const uint8_t *rom, uint8_t *scratchpad)
+{
+	if (DS18B20_Select(bus, rom, cmd_DS18x20_ReadScratchpad) == 0) return 0;
+	bus->pxReadBlock(scratchpad, DS18B20_SCRATCHPAD_SIZE);
+	/**< zwarta magistrala daje same zera, dla ktrych suma CRC rwnie wynosi 0 */
+	return (OneWire_CRC8(scratchpad, DS18B20_SCRATCHPAD_SIZE) == 0) &&
+	       DS18B20_ScratchpadValid(scratchpad);
+}
+
+uint8_t DS18B20_ScratchpadValid(const uint8_t *scratchpad)
+{
+	uint8_t any = 0x00, all = 0xFF;
+
+	for (uint8_t i = 0; i < DS18B20_SCRATCHPAD_SIZE; i++)
+	{
+		any |= scratchpad[i];
+		all &= scratchpad[i];
+	}
+	return (any != 0x00) && (all != 0xFF);
+}
+
+uint8_t DS18B20_SetResolution(const DS18B20_Bus *bus, const uint8_t *rom, uint8_t bits, uint8_t copy)
+{
+	uint8_t scratchpad[DS18B20_SCRATCHPAD_SIZE];
+	uint8_t config[3];
+
+	if ((bits < DS18B20_RESOLUTION_MIN) || (bits > DS18B20_RESOLUTION_MAX)) return 0;
+	/**< rozkaz WriteScratchpad zapisuje zawsze trzy bajty: TH, TL i konfiguracj */
+	if (DS18B20_ReadScratchpad(bus, rom, scratchpad) == 0) return 0;
+	config[0] = scratchpad[DS18B20_SP_TH];
+	config[1] = scratchpad[DS18B20_SP_TL];
+	config[2] = DS18B20_CONFIG(bits);
+	if (DS18B20_Select(bus, rom, cmd_DS18x20_WrireScratchpad) == 0) return 0;
+	bus->pxWriteBlock(config, sizeof(config));
+
+	/**< weryfikacja zapisu */
+	if (DS18B20_ReadScratchpad(bus, rom, scratchpad) == 0) return 0;
+	if (copy && (scratchpad[DS18B20_SP_CONFIG] == config[2]))
+	{
+		/**< zapis EEPROM rozpoczynany jest po ostatnim bicie rozkazu */
+		if (DS18B20_Select(bus, rom, cmd_DS18x20_CopyScratchpad) == 0) return 0;
+	}
+	return DS18B20_GetResolution(scratchpad);
+}
+
+uint8_t DS18B20_ConversionDone(const DS18B20_Bus *bus)
+{
+	return bus->pxReadBit() != 0;
+}
+
+uint8_t DS18B20_GetResolution(const uint8_t *scratchpad)
+{
+	return DS18B20_RESOLUTION_MIN + ((scratchpad[DS18B20_SP_CONFIG] >> 5) & 0x03);
+}
+
+uint16_t DS18B20_ConversionTime(uint8_t bits)
+{
+	/**< tCONV = 750ms / 2^(12 - bits): 93,75ms, 187,5ms, 375ms, 750ms,
+	     zaokrglone w gr */
+	switch (bits)
+	{
+		case 9:		return 94;
+		case 10:	return 188;
+		case 11:	return 375;
+		default:	return 750;
+	}
+}
+
+uint16_t DS18B20_GetTemperature(const uint8_t *scratchpad)
+{
+	uint16_t temperature = ((uint16_t)scratchpad[DS18B20_SP_TEMP_MSB] << 8) |
+	                       scratchpad[DS18B20_SP_TEMP_LSB];
+
+	/**< 9 bitw - nieokrelone bity 2..0, 10 bitw - 1..0, 11 bitw - 0 */
+	return temperature & (0xFFFF << (DS18B20_RESOLUTION_MAX - DS18B20_GetResolution(scratchpad)));
+}
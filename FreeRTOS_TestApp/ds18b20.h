@@ -1,6 +1,22 @@
+/** @file ds18b20.h
+  *
+  * @author B.W.
+  *
+  * Biblioteka do obsugi czujnika temperatury DS18B20: konfiguracja
+  * rozdzielczoci pomiaru (9..12 bitw), odczyt pamici RAM (scratchpad)
+  * oraz wyznaczenie czasu konwersji dla biecej rozdzielczoci
+  *
+  * Transmisja odbywa si przez funkcje biblioteki ukadu MASTER (spi1wire.h,
+  * usart1wire.h), wskazane w opisie magistrali DS18B20_Bus; biblioteka nie
+  * zaley od adnej z nich (suma CRC8 - onewire_crc.h).
+  *
+  */
+
 #ifndef DS18B20_H_
 #define DS18B20_H_
 
+#include <stdint.h>
+
 //
 // Podstawowe polecenia ukladu DS18B20
 //
@@ -16,4 +32,144 @@
 #define cmd_DS18x20_RecallEE		0xB8
 #define cmd_DS18x20_ReadPowerSupply	0xB4
 
+#define DS18B20_FAMILY				0x28	/**< kod rodziny (pierwszy bajt identyfikatora ROM) */
+#define DS18B20_ROM_SIZE			8		/**< dugo identyfikatora ROM w bajtach */
+
+/**
+  * @def pami RAM ukadu (scratchpad), pooenie pl
+  */
+#define DS18B20_SCRATCHPAD_SIZE		9
+#define DS18B20_SP_TEMP_LSB			0
+#define DS18B20_SP_TEMP_MSB			1
+#define DS18B20_SP_TH				2	/**< prg alarmu grny */
+#define DS18B20_SP_TL				3	/**< prg alarmu dolny */
+#define DS18B20_SP_CONFIG			4	/**< rejestr konfiguracji: 0 R1 R0 1 1 1 1 1 */
+#define DS18B20_SP_CRC				8
+
+/**
+  * @def rozdzielczo pomiaru [bity] oraz rejestr konfiguracji
+  */
+#define DS18B20_RESOLUTION_MIN		9	/**< 0,5C, konwersja maks. 93,75ms */
+#define DS18B20_RESOLUTION_MAX		12	/**< 0,0625C, konwersja maks. 750ms
+                                             (ustawienie fabryczne) */
+#define DS18B20_CONFIG(bits)		((uint8_t)((((bits) - DS18B20_RESOLUTION_MIN) << 5) | 0x1F))
+
+/**< czas zapisu pamici EEPROM rozkazem CopyScratchpad [ms] */
+#define DS18B20_COPY_TIME_MS		10
+
+/**
+  * Opis magistrali 1-Wire, do ktrej doczony jest czujnik
+  *
+  * Sygnatury funkcji zgodne s z funkcjami bibliotek spi1wire.h i usart1wire.h,
+  * np. { SPI1Wire_ResetPresence, SPI1Wire_WriteBlock, SPI1Wire_ReadBlock,
+  * SPI1Wire_ReadBit }.
+  */
+typedef struct
+{
+	uint8_t (*pxResetPresence)(void);		/**< sekwencja RESET-PULSE-PRESENCE,
+	                                             0 - brak ukadw SLAVE */
+	void (*pxWriteBlock)(const uint8_t *buffer, uint16_t length);
+	void (*pxReadBlock)(uint8_t *buffer, uint16_t length);
+	uint8_t (*pxReadBit)(void);				/**< pojedyncza szczelina odczytu */
+} DS18B20_Bus;
+
+/**
+  * Funkcja odczytujca pami RAM (scratchpad) czujnika
+  *
+  * Czujnik wybierany jest rozkazem MatchROM lub, dla rom rwnego NULL,
+  * SkipROM (na magistrali moe by wwczas tylko jeden ukad).
+  *
+  * @param  [in] bus opis magistrali
+  * @param  [in] rom identyfikator czujnika (8 bajtw) lub NULL
+  * @param  [out] scratchpad bufor na DS18B20_SCRATCHPAD_SIZE bajtw
+  * @return 0 - brak odpowiedzi ukadw SLAVE, bd CRC lub jednolita zawarto
+  *         (DS18B20_ScratchpadValid), w przeciwnym razie warto rna od zera
+  *
+  */
+uint8_t DS18B20_ReadScratchpad(const DS18B20_Bus *bus, const uint8_t *rom, uint8_t *scratchpad);
+
+/**
+  * Funkcja sprawdzajca, czy odczytana pami RAM czujnika nie jest jednolita
+  *
+  * Magistrala bez odpowiedzi w szczelinach odczytu daje same jedynki, zwarta
+  * (stan niski) - same zera, dla ktrych suma CRC8 rwnie wynosi 0. Funkcja
+  * uzupenia sprawdzenie CRC dla bibliotek wyznaczajcych sum w trakcie
+  * odczytu (SPI1Wire_GetCRC8).
+  *
+  * @param  [in] scratchpad odczytana pami RAM (DS18B20_SCRATCHPAD_SIZE bajtw)
+  * @return 0 - wszystkie bajty 0x00 lub wszystkie 0xFF, w przeciwnym razie
+  *         warto rna od zera
+  *
+  */
+uint8_t DS18B20_ScratchpadValid(const uint8_t *scratchpad);
+
+/**
+  * Funkcja ustawiajca rozdzielczo pomiaru temperatury
+  *
+  * Rejestr konfiguracji zapisywany jest rozkazem WriteScratchpad (progi alarmu
+  * TH i TL odczytywane s wczeniej i zapisywane bez zmian), a nastpnie
+  * odczytywany w celu weryfikacji. Opcjonalnie konfiguracja zapisywana jest
+  * w pamici EEPROM rozkazem CopyScratchpad - kolejny rozkaz mona wysa
+  * po DS18B20_COPY_TIME_MS; czujniki zasilane pasoytniczo wymagaj w tym
+  * czasie silnego podcigania magistrali, ktrego funkcja nie zapewnia.
+  *
+  * @param  [in] bus opis magistrali
+  * @param  [in] rom identyfikator czujnika (8 bajtw) lub NULL (SkipROM)
+  * @param  bits rozdzielczo 9..12 (DS18B20_RESOLUTION_xxx)
+  * @param  copy 0 - wycznie pami RAM, w przeciwnym razie rwnie EEPROM
+  * @return rozdzielczo odczytana z ukadu po zapisie (9..12) lub 0 - brak
+  *         odpowiedzi, bd CRC lub nieprawidowa warto bits
+  *
+  */
+uint8_t DS18B20_SetResolution(const DS18B20_Bus *bus, const uint8_t *rom, uint8_t bits, uint8_t copy);
+
+/**
+  * Funkcja sprawdzajca zakoczenie konwersji temperatury
+  *
+  * Po rozkazie ConvertT czujnik zasilany zewntrznie odpowiada w szczelinach
+  * odczytu 0 do zakoczenia konwersji, a nastpnie 1. Funkcja wykonuje jedn
+  * szczelin odczytu (ok. 70us), bez sekwencji RESET - pomidzy wywoaniami
+  * zadanie moe odda procesor.
+  *
+  * @note Nie moe by stosowana dla czujnikw zasilanych pasoytniczo - magistrala
+  *       podtrzymywana jest wwczas silnym podciganiem, szczelina odczytu
+  *       przerwaaby zasilanie konwersji.
+  *
+  * @param  [in] bus opis magistrali
+  * @return 0 - konwersja w toku, w przeciwnym razie warto rna od zera
+  *
+  */
+uint8_t DS18B20_ConversionDone(const DS18B20_Bus *bus);
+
+/**
+  * Funkcja wyznaczajca rozdzielczo z odczytanej pamici RAM czujnika
+  *
+  * @param  [in] scratchpad odczytana pami RAM (DS18B20_SCRATCHPAD_SIZE bajtw)
+  * @return rozdzielczo 9..12
+  *
+  */
+uint8_t DS18B20_GetResolution(const uint8_t *scratchpad);
+
+/**
+  * Funkcja zwracajca maksymalny czas konwersji dla danej rozdzielczoci
+  *
+  * @param  bits rozdzielczo 9..12; inna warto (np. 0 - nieznana) traktowana
+  *         jest jak 12 bitw
+  * @return czas konwersji [ms]: 94, 188, 375 lub 750
+  *
+  */
+uint16_t DS18B20_ConversionTime(uint8_t bits);
+
+/**
+  * Funkcja pobierajca temperatur z odczytanej pamici RAM czujnika
+  *
+  * Bity nieokrelone dla rozdzielczoci mniejszej ni 12 bitw (najmodsze)
+  * s zerowane.
+  *
+  * @param  [in] scratchpad odczytana pami RAM (DS18B20_SCRATCHPAD_SIZE bajtw)
+  * @return temperatura w formacie ukadu (U2, 1/16C)
+  *
+  */
+uint16_t DS18B20_GetTemperature(const uint8_t *scratchpad);
+
 #endif //DS18B20_H_
\ No newline at end of file
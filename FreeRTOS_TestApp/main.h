@@ -9,4 +9,10 @@
 #define LCD_BKLight		3
 #define LCD_DATA        4
 
+/**< silne podciganie magistrali 1-Wire (bramka tranzystora P-MOSFET),
+     biblioteka spi1wire.h */
+#define SPI1WIRE_PULLUP_PORT	PORTB
+#define SPI1WIRE_PULLUP_DDR		DDRB
+#define SPI1WIRE_PULLUP_PIN		PB3
+
 #endif//MAIN_H
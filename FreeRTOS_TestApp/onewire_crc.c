@@ -0,0 +1,22 @@
+/** @file onewire_crc.c
+  */
+
+#include "onewire_crc.h"
+
+uint8_t OneWire_CRC8(const uint8_t *buffer, uint16_t length)
+{
+	uint8_t crc = 0;
+
+	while (length--)
+	{
+		uint8_t byte = *buffer++;
+
+		for (uint8_t i = 0; i < 8; i++)
+		{
+			if ((crc ^ byte) & 0x01) crc = (crc >> 1) ^ 0x8C;
+			else crc >>= 1;
+			byte >>= 1;
+		}
+	}
+	return crc;
+}
@@ -0,0 +1,26 @@
+/** @file onewire_crc.h
+  *
+  * @author B.W.
+  *
+  * Suma kontrolna CRC8 interfejsu 1-Wire (Dallas/Maxim, x^8 + x^5 + x^4 + 1),
+  * wsplna dla bibliotek ukadw MASTER (spi1wire.h, usart1wire.h) oraz
+  * ukadw SLAVE (ds18b20.h)
+  *
+  */
+
+#ifndef ONEWIRE_CRC_H_
+#define ONEWIRE_CRC_H_
+
+#include <stdint.h>
+
+/**
+  * Funkcja wyznaczajca sum kontroln CRC8 (Dallas/Maxim, x^8 + x^5 + x^4 + 1)
+  *
+  * @param  [in] buffer dane
+  * @param  length liczba bajtw
+  * @return suma kontrolna; dla danych zakoczonych poprawn sum wynosi 0
+  *
+  */
+uint8_t OneWire_CRC8(const uint8_t *buffer, uint16_t length);
+
+#endif //ONEWIRE_CRC_H_
@@ -1,7 +1,73 @@
 /** @file spi1wire.c
   */
 
+#include <stddef.h>
+#include <string.h>
+
+/**< FreeRTOSConfig.h doczany przed spi1wire.h, jak w pozostaych moduach
+     projektu - rozmiar stosu wyznaczany jest bez wartoci domylnych spi1wire.h */
+#if !defined(SPI1WIRE_USE_FREERTOS) || SPI1WIRE_USE_FREERTOS
+#include "FreeRTOS.h"
+#endif
+
 #include "spi1wire.h"
+#include "spi1wire_timing.h"
+
+#if !SPI1WIRE_USE_FREERTOS
+#include <util/delay.h>
+#endif
+
+#if SPI1WIRE_USE_FREERTOS
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+/**< semafor binarny sygnalizujcy zakoczenie sekwencji interfejsu 1-Wire */
+static xSemaphoreHandle spi_1wire_ready = NULL;
+#endif
+
+/**< ramki przerwania od SPI i zagniedonego przerwania na stosie kadego zadania;
+     SPI1WIRE_NESTED_ISR = 1 zmienione wycznie w spi1wire.h pozostawia
+     configMINIMAL_STACK_SIZE (FreeRTOSConfig.h) bez zmian */
+#if SPI1WIRE_NESTED_ISR && SPI1WIRE_USE_FREERTOS && (configMINIMAL_STACK_DEPTH < 125)
+#error "SPI1WIRE_NESTED_ISR = 1 wymaga configMINIMAL_STACK_SIZE >= 125 - symbol nalezy ustawic w opcjach kompilatora"
+#endif
+
+#if SPI1WIRE_NESTED_ISR
+/**< bity SPI1WIRE_NESTED_TIMSK i SPI1WIRE_NESTED_UCSRB odblokowane przed analiz
+     szczeliny; program obsugi przerwania od SPI nie jest zagniedany (SPIE) */
+static uint8_t spi_1wire_nested_timsk = 0;
+static uint8_t spi_1wire_nested_ucsrb = 0;
+
+/**
+  * Zablokowanie przerwa mogcych przeczy kontekst na czas analizy szczeliny
+  * przy odblokowanych przerwaniach, wywoywane przy zablokowanych przerwaniach
+  *
+  * Funkcje systemu FreeRTOS (np. vTaskSuspendAll) nie s wywoywane - nie s
+  * przeznaczone dla programw obsugi przerwa. Zgoszenia zablokowanych
+  * przerwa obsugiwane s po wyjciu z programu obsugi przerwania od SPI.
+  */
+static inline void SPI1Wire_NestedEnter(void)
+{
+	uint8_t timsk = TIMSK;
+	uint8_t ucsrb = UCSRB;
+
+	spi_1wire_nested_timsk = timsk & SPI1WIRE_NESTED_TIMSK;
+	spi_1wire_nested_ucsrb = ucsrb & SPI1WIRE_NESTED_UCSRB;
+	TIMSK = timsk & ~SPI1WIRE_NESTED_TIMSK;
+	UCSRB = ucsrb & ~SPI1WIRE_NESTED_UCSRB;
+}
+
+/**
+  * Przywrcenie przerwa zablokowanych przez SPI1Wire_NestedEnter, wywoywane
+  * przy zablokowanych przerwaniach
+  */
+static inline void SPI1Wire_NestedExit(void)
+{
+	TIMSK |= spi_1wire_nested_timsk;
+	UCSRB |= spi_1wire_nested_ucsrb;
+}
+#endif
 
 void SPI1Wire_Init(void)
 {
@@ -9,148 +75,1202 @@ void SPI1Wire_Init(void)
 	PORTB |= (1 << SS);               /**< ustawi wejcie w stan wysoki, jak tutaj */
 	SPCR = (1 << SPE)  |			  /**< odblokowanie ukadu SPI */
 	       (1 << MSTR) |			  /**< tryb pracy jako MASTER */
-		   (1 << SPR1) |              /**< ustawienie dzielnika sygnau zegarowego na 128 */
-		   (1 << SPR0);
+		   SPI1WIRE_STD_SPCR;         /**< dzielnik sygnau zegarowego wyznaczony dla F_CPU
+		                                   (128 dla 14,7456MHz), plik spi1wire_timing.h */
+	SPSR = SPI1WIRE_STD_SPSR;
+#ifdef SPI1WIRE_PULLUP_PIN
+	/**< wyprowadzenie silnego podcigania: stan nieaktywny, nastpnie wyjcie */
+	SPI1WIRE_STRONG_PULLUP_OFF();
+	SPI1WIRE_PULLUP_DDR |= (1 << SPI1WIRE_PULLUP_PIN);
+#endif
+#if SPI1WIRE_USE_FREERTOS
+	/**< utworzenie semafora oraz jego wstpne zerowanie, semafor zwalniany jest
+	     wycznie przez program obsugi przerwania ISR */
+	vSemaphoreCreateBinary(spi_1wire_ready);
+	xSemaphoreTake(spi_1wire_ready, 0);
+#endif
 }
 
 /**
   * Niskopoziomowa funkcja (program obsugi przerwania od ukadu SPI) wykorzystana
   * do generowania podstawowych sekwencji przebiegw na magistrali 1-Wire
   *
+  * Szczeliny przetwarzane s potokowo: wzorzec kolejnej szczeliny (spi_1wire_next)
+  * wyznaczany jest z wyprzedzeniem o jedn szczelin, dziki czemu program obsugi
+  * przerwania wpisuje go do SPDR bezporednio po wejciu, przed analiz szczeliny
+  * zakoczonej. Przerwa pomidzy szczelinami ograniczona jest do czasu wejcia
+  * do programu obsugi przerwania.
   */
 
-volatile uint8_t spi_1wire_command = 0; /**< zakodowany rozkaz do wykonania, opis w pliku spi1wire.h */
-volatile uint8_t spi_1wire_data = 0;    /**< dana do zapisu lub odczytana z magistrali 1-Wire */
+static volatile uint8_t spi_1wire_command = 0; /**< zakodowany rozkaz do wykonania, opis w pliku spi1wire.h;
+                                             licznik LLLL wskazuje kolejn wyznaczan szczelin */
+static volatile uint8_t spi_1wire_data = 0;    /**< dana odczytana z magistrali 1-Wire (wynik rozkazu) */
+static volatile uint8_t spi_1wire_presence = 0; /**< wynik ostatniej sekwencji RESET-PULSE-PRESENCE */
+static uint8_t * volatile spi_1wire_buffer = NULL; /**< biecy bajt bloku danych */
+static volatile uint16_t spi_1wire_length = 0;     /**< liczba bajtw bloku pozostaych do przesania */
+static uint8_t * volatile spi_1wire_read_buffer = NULL; /**< miejsce zapisu kolejnego odczytanego bajtu */
+static volatile uint16_t spi_1wire_read_length = 0;     /**< liczba bajtw fazy odczytu pozostaych
+                                                             do wyznaczenia */
+static volatile uint8_t spi_1wire_flags = 0;            /**< znaczniki SPI1WIRE_TR_xxx biecej transakcji */
+static volatile uint8_t spi_1wire_shift = 0;            /**< wysyany bajt, przesuwany o kolejne bity */
+static volatile uint8_t spi_1wire_next = 0;             /**< wzorzec kolejnej szczeliny */
+static volatile uint8_t spi_1wire_next_action = 0;      /**< czynno po zakoczeniu kolejnej szczeliny */
+static volatile uint8_t spi_1wire_action = 0;           /**< czynno po zakoczeniu biecej szczeliny */
+static volatile uint8_t spi_1wire_crc = 0;              /**< suma CRC8 bitw odczytanych w biecym rozkazie */
+static volatile uint8_t spi_1wire_error = SPI1WIRE_ERR_NONE; /**< wynik ostatniego rozkazu */
+static uint8_t spi_1wire_speed = SPI1WIRE_SPEED_STANDARD; /**< bieca prdko transmisji */
+static uint8_t spi_1wire_read_mask = SPI1WIRE_STD_READ_MASK; /**< bity SPDR, ktre w szczelinie odczytu
+                                                             o wartoci 1 musz mie stan wysoki */
+static uint8_t spi_1wire_pattern_1 = SPI1WIRE_STD_PATTERN_1; /**< wzorzec szczeliny zapisu 1 i odczytu */
+static uint8_t spi_1wire_std_mask = SPI1WIRE_STD_READ_MASK;  /**< maska odczytu prdkoci standardowej
+                                                             (wyznaczona przez SPI1Wire_Calibrate) */
+#if SPI1WIRE_OVERDRIVE
+static uint8_t spi_1wire_od_mask = SPI1WIRE_OD_READ_MASK;    /**< j.w. dla prdkoci overdrive */
+#endif
+static uint8_t spi_1wire_selected[SPI1WIRE_ROM_SIZE];  /**< ukad wybrany ostatnio rozkazem Match ROM */
+static uint8_t spi_1wire_selected_valid = 0;           /**< ukad spi_1wire_selected ma ustawiony
+                                                            znacznik RC (rozkaz Resume) */
+static uint8_t spi_1wire_rom_phase = 0;                /**< kolejny zapisywany bajt to rozkaz
+                                                            warstwy ROM (po sekwencji RESET) */
+
+/**
+  * @def czynnoci wykonywane po zakoczeniu szczeliny (wartoci kolejne, wybr
+  *      czynnoci kompilowany jest do tablicy skokw)
+  */
+#define SPI1WIRE_ACT_NONE			0		/**< szczelina zapisu, bez analizy odpowiedzi */
+#define SPI1WIRE_ACT_PRESENCE		1		/**< identyfikacja impulsu PRESENCE */
+#define SPI1WIRE_ACT_PRESENCE_OD	2		/**< j.w. w trybie overdrive */
+#define SPI1WIRE_ACT_READ			3		/**< odczyt bitu */
+#define SPI1WIRE_ACT_READ_STORE		4		/**< odczyt ostatniego bitu i zapis bajtu */
+#define SPI1WIRE_ACT_TRIPLET_ID		5		/**< odczyt bitu identyfikatora */
+#define SPI1WIRE_ACT_TRIPLET_CMP	6		/**< odczyt dopenienia i wysanie kierunku */
+#define SPI1WIRE_ACT_CAPTURE		7		/**< zapis prbek szczeliny do bufora odczytu */
+#define SPI1WIRE_ACT_MASK			0x7F
+#define SPI1WIRE_ACT_NEXT			0x80	/**< kolejna szczelina przygotowana w spi_1wire_next */
+
+/**< znacznik wewntrzny (spi_1wire_flags): zapis prbek sekwencji PULSE zamiast
+     identyfikacji impulsu PRESENCE oraz prbek szczelin odczytu zamiast bitw,
+     wykorzystywany przez SPI1Wire_ResetDiagnostic i SPI1Wire_Calibrate */
+#define SPI1WIRE_TR_CAPTURE			0x80
+
+#if SPI1WIRE_TRACE
+#if ((SPI1WIRE_TRACE_SIZE & (SPI1WIRE_TRACE_SIZE - 1)) != 0) || (SPI1WIRE_TRACE_SIZE > 128)
+#error "SPI1WIRE_TRACE_SIZE musi byc potega 2, nie wieksza niz 128"
+#endif
+
+/**< bufor cykliczny zdarze programu obsugi przerwania; zapisywany wycznie
+     w programie obsugi przerwania (spi_1wire_trace_head), odczytywany wycznie
+     przez zadanie (spi_1wire_trace_tail) - indeksy 8-bitowe, zapis atomowy */
+static volatile SPI1Wire_TraceEntry spi_1wire_trace[SPI1WIRE_TRACE_SIZE];
+static volatile uint8_t spi_1wire_trace_head = 0;    /**< kolejny zapisywany wpis */
+static volatile uint8_t spi_1wire_trace_tail = 0;    /**< kolejny odczytywany wpis */
+static volatile uint8_t spi_1wire_trace_dropped = 0; /**< wpisy pominite przy penym buforze */
+
+/**
+  * Zapis zdarzenia programu obsugi przerwania, wywoywane wycznie z ISR
+  *
+  * Wpis uzupeniany jest przed przesuniciem indeksu zapisu, dziki czemu
+  * zadanie odczytujce widzi wycznie kompletne wpisy.
+  */
+static inline void SPI1Wire_TraceRecord(uint16_t time, uint8_t action, uint8_t out, uint8_t in)
+{
+	uint8_t head = spi_1wire_trace_head;
+	uint8_t next = (head + 1) & (SPI1WIRE_TRACE_SIZE - 1);
+
+	if (next == spi_1wire_trace_tail)
+	{
+		if (spi_1wire_trace_dropped != 0xFF) spi_1wire_trace_dropped++;
+		return;
+	}
+	spi_1wire_trace[head].time = time;
+#if SPI1WIRE_USE_FREERTOS
+	spi_1wire_trace[head].tick = (uint8_t)xTaskGetTickCountFromISR();
+#else
+	spi_1wire_trace[head].tick = 0;
+#endif
+	spi_1wire_trace[head].action = action;
+	spi_1wire_trace[head].out = out;
+	spi_1wire_trace[head].in = in;
+	/**< wynik czynnoci: licznik impulsw PRESENCE lub bajt/znaczniki odczytu */
+	if (((action & SPI1WIRE_ACT_MASK) == SPI1WIRE_ACT_PRESENCE) ||
+	    ((action & SPI1WIRE_ACT_MASK) == SPI1WIRE_ACT_PRESENCE_OD))
+		spi_1wire_trace[head].result = spi_1wire_presence;
+	else spi_1wire_trace[head].result = spi_1wire_data;
+	spi_1wire_trace_head = next;
+}
+
+uint8_t SPI1Wire_TraceRead(SPI1Wire_TraceEntry *entry)
+{
+	uint8_t tail = spi_1wire_trace_tail;
+
+	if (tail == spi_1wire_trace_head) return 0;
+	entry->time = spi_1wire_trace[tail].time;
+	entry->tick = spi_1wire_trace[tail].tick;
+	entry->action = spi_1wire_trace[tail].action;
+	entry->out = spi_1wire_trace[tail].out;
+	entry->in = spi_1wire_trace[tail].in;
+	entry->result = spi_1wire_trace[tail].result;
+	spi_1wire_trace_tail = (tail + 1) & (SPI1WIRE_TRACE_SIZE - 1);
+	return 1;
+}
+
+uint8_t SPI1Wire_TraceDropped(void)
+{
+	uint8_t dropped = spi_1wire_trace_dropped;
+
+	spi_1wire_trace_dropped = 0;
+	return dropped;
+}
+
+#define SPI1WIRE_TRACE_RECORD()		SPI1Wire_TraceRecord(trace_time, action, trace_out, sample)
+#else
+#define SPI1WIRE_TRACE_RECORD()		do { } while (0)
+#endif
+
+#if SPI1WIRE_CAPTURE
+static SPI1Wire_SlotCapture * volatile spi_1wire_capture = NULL; /**< kolejny wpis bufora prbek */
+static volatile uint16_t spi_1wire_capture_left = 0;  /**< wolne wpisy bufora, 0 - rejestracja wyczona */
+static uint16_t spi_1wire_capture_size = 0;           /**< rozmiar bufora prbek */
+
+/**
+  * Zapis prbek zakoczonej szczeliny, wywoywane wycznie z ISR
+  *
+  * Warto bitu wyznaczana jest ponownie, tak jak w analizie szczeliny
+  * (dla biecej maski odczytu i prdkoci).
+  */
+static inline void SPI1Wire_CaptureRecord(uint8_t action, uint8_t sample)
+{
+	uint16_t left = spi_1wire_capture_left;
+	SPI1Wire_SlotCapture *entry;
+	uint8_t bit = SPI1WIRE_CAPTURE_NO_BIT;
+
+	if (left == 0) return;
+	switch (action & SPI1WIRE_ACT_MASK)
+	{
+		case SPI1WIRE_ACT_PRESENCE:
+					bit = (sample & SPI1WIRE_STD_PRESENCE_MASK) != 0;
+					break;
+		case SPI1WIRE_ACT_PRESENCE_OD:
+					bit = (sample & SPI1WIRE_OD_PRESENCE_MASK) != 0;
+					break;
+		case SPI1WIRE_ACT_READ:
+		case SPI1WIRE_ACT_READ_STORE:
+		case SPI1WIRE_ACT_TRIPLET_ID:
+		case SPI1WIRE_ACT_TRIPLET_CMP:
+					bit = (sample & spi_1wire_read_mask) == spi_1wire_read_mask;
+					break;
+	}
+	entry = spi_1wire_capture;
+	entry->raw = sample;
+	entry->bit = bit;
+	spi_1wire_capture = entry + 1;
+	spi_1wire_capture_left = left - 1;
+}
+
+void SPI1Wire_CaptureStart(SPI1Wire_SlotCapture *buffer, uint16_t size)
+{
+	uint8_t sreg = SREG;
+
+	cli();
+	spi_1wire_capture = buffer;
+	spi_1wire_capture_size = size;
+	spi_1wire_capture_left = size;
+	SREG = sreg;
+}
+
+uint16_t SPI1Wire_CaptureStop(void)
+{
+	uint8_t sreg = SREG;
+	uint16_t stored;
+
+	cli();
+	stored = spi_1wire_capture_size - spi_1wire_capture_left;
+	spi_1wire_capture_left = 0;
+	spi_1wire_capture_size = 0;
+	SREG = sreg;
+	return stored;
+}
+
+#define SPI1WIRE_CAPTURE_RECORD()	SPI1Wire_CaptureRecord(action, sample)
+#else
+#define SPI1WIRE_CAPTURE_RECORD()	do { } while (0)
+#endif
+
+/**
+  * Zakoczenie sekwencji, wywoywane wycznie z programu obsugi przerwania ISR
+  *
+  * Ustawiany jest znacznik SPI1WIRE_CMD_READY, blokowane jest przerwanie od
+  * interfejsu SPI oraz (w trybie SPI1WIRE_USE_FREERTOS) budzone jest zadanie
+  * oczekujce na zakoczenie sekwencji.
+  */
+static inline void SPI1Wire_Complete(void)
+{
+	/**< podtrzymanie magistrali (np. na czas konwersji) tu po ostatnim bicie */
+	if (spi_1wire_flags & SPI1WIRE_TR_PULLUP) SPI1WIRE_STRONG_PULLUP_ON();
+	spi_1wire_command |= SPI1WIRE_CMD_READY;
+	SPCR &= ~(1 << SPIE);
+#if SPI1WIRE_USE_FREERTOS
+	signed portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+
+	xSemaphoreGiveFromISR(spi_1wire_ready, &xHigherPriorityTaskWoken);
+	/**< obudzone zadanie moe mie wyszy priorytet ni zadanie przerwane */
+	if (xHigherPriorityTaskWoken != pdFALSE)
+	{
+		taskYIELD();
+	}
+#endif
+}
+
+/**
+  * Wyznaczenie kolejnej szczeliny transakcji
+  *
+  * Na podstawie rozkazu (spi_1wire_command) wyznaczany jest wzorzec bajtu SPI
+  * (spi_1wire_next) oraz czynno wykonywana po zakoczeniu szczeliny
+  * (spi_1wire_next_action), rozkaz przesuwany jest na kolejn szczelin;
+  * po ostatniej szczelinie fazy wybierana jest faza nastpna.
+  * Wywoywane z programu obsugi przerwania ISR oraz, przy zablokowanym
+  * przerwaniu, przez funkcje biblioteki rozpoczynajce rozkaz.
+  *
+  * @return 0 - brak kolejnych szczelin (koniec rozkazu lub oczekiwanie na wynik
+  *         szczeliny biecej), w przeciwnym razie warto rna od zera
+  */
+static inline uint8_t SPI1Wire_Produce(void)
+{
+	uint8_t command = spi_1wire_command;
+	uint8_t counter = command & SPI1WIRE_CMD_CNT_MASK;
+	uint8_t pattern = spi_1wire_pattern_1;
+	uint8_t action = SPI1WIRE_ACT_NONE;
+
+	switch (command >> 4)
+	{
+		/**< Rozkaz RESET-PULSE, liczba bajtw sekwencji wyznaczona dla F_CPU
+		     (dla 14,7456MHz 8 bajtw 0x00 - 555us, przy SPI1WIRE_FAST_PROFILE 7 bajtw
+		     - 486us, oraz 4 bajty 0xFF - 278us;
+		     w trybie overdrive 6 bajtw 0x00 - 52us, dopuszczalne 48..80us,
+		     oraz 6 bajtw 0xFF) */
+		case SPI1WIRE_CMD_RESETPULSE >> 4:
+		case SPI1WIRE_CMD_RESETPULSE_OD >> 4:
+		{
+			uint8_t od = (command & SPI1WIRE_CMD_RESETPULSE_OD) != 0;
+			uint8_t low = od ? SPI1WIRE_OD_RESET_BYTES : SPI1WIRE_STD_RESET_BYTES;
+			uint8_t high = od ? SPI1WIRE_OD_RSTH_BYTES : SPI1WIRE_STD_RSTH_BYTES;
+
+			if (counter < low)
+			{
+				/**< sekwencja RESET */
+				pattern = SPI1WIRE_PATTERN_0;
+			}
+			else
+			{
+				/**< sekwencja PULSE, impuls PRESENCE identyfikowany w pierwszym bajcie
+				     po zwolnieniu magistrali */
+				pattern = 0xFF;
+				if (spi_1wire_flags & SPI1WIRE_TR_CAPTURE) action = SPI1WIRE_ACT_CAPTURE;
+				else if (counter == low) action = od ? SPI1WIRE_ACT_PRESENCE_OD : SPI1WIRE_ACT_PRESENCE;
+			}
+			if (counter != low + high - 1)
+			{
+				command++;
+				break;
+			}
+			/**< ostatnia szczelina sekwencji, wynik identyfikacji impulsu PRESENCE
+			     jest ju znany (okno obejmuje co najmniej 3 bajty); brak ukadw
+			     SLAVE przerywa transakcj, w przeciwnym razie kolejna faza: zapis,
+			     odczyt lub zakoczenie */
+			if (spi_1wire_presence == SPI1WIRE_NO_PRESENCE) command = SPI1WIRE_CMD_END;
+			else if (spi_1wire_length != 0)
+			{
+				/**< pierwszy bajt zapisu (spi_1wire_shift) wyznaczony przy rozpoczciu
+				     transakcji */
+				command = SPI1WIRE_CMD_WRITE;
+			}
+			else if (spi_1wire_read_length != 0) command = SPI1WIRE_CMD_READ;
+			else command = SPI1WIRE_CMD_END;
+			break;
+		}
+
+		/**< Rozkaz READ */
+		case SPI1WIRE_CMD_READ >> 4:
+			if (counter == 0x07)
+			{
+				/**< ostatni bit bajtu, zapis bajtu do bufora */
+				action = SPI1WIRE_ACT_READ_STORE;
+				command = (--spi_1wire_read_length != 0) ? SPI1WIRE_CMD_READ : SPI1WIRE_CMD_END;
+			}
+			else
+			{
+				action = SPI1WIRE_ACT_READ;
+				command = SPI1WIRE_CMD_READ | (counter + 1);
+			}
+			/**< kalibracja, zapis prbek kadej szczeliny */
+			if (spi_1wire_flags & SPI1WIRE_TR_CAPTURE) action = SPI1WIRE_ACT_CAPTURE;
+			break;
 
+		/**< Rozkazy WRITE i TOUCH, wysyany bit wysuwany jest z najmodszej pozycji */
+		case SPI1WIRE_CMD_WRITE >> 4:
+		case SPI1WIRE_CMD_TOUCH >> 4:
+		{
+			uint8_t shift = spi_1wire_shift;
+			uint8_t touch = command & (SPI1WIRE_CMD_TOUCH ^ SPI1WIRE_CMD_WRITE); /**< bit T */
+
+			if ((shift & 0x01) == 0) pattern = SPI1WIRE_PATTERN_0;
+			if (touch)
+				action = (counter == 0x07) ? SPI1WIRE_ACT_READ_STORE : SPI1WIRE_ACT_READ;
+			if (counter != 0x07)
+			{
+				spi_1wire_shift = shift >> 1;
+				command++;
+			}
+			else if (--spi_1wire_length != 0)
+			{
+				/**< kolejny bajt bloku */
+				spi_1wire_shift = *++spi_1wire_buffer;
+				command &= ~SPI1WIRE_CMD_CNT_MASK;
+			}
+			else if ((touch == 0) && (spi_1wire_read_length != 0))
+			{
+				/**< faza odczytu transakcji */
+				command = SPI1WIRE_CMD_READ;
+			}
+			else command = SPI1WIRE_CMD_END;
+			break;
+		}
+
+		/**< Rozkaz TRIPLET: odczyt bitu identyfikatora i dopenienia; kierunek
+		     zaley od wyniku obu szczelin, dlatego jest wysyany po ich analizie */
+		case SPI1WIRE_CMD_TRIPLET >> 4:
+			action = (counter == 0) ? SPI1WIRE_ACT_TRIPLET_ID : SPI1WIRE_ACT_TRIPLET_CMP;
+			command = (counter == 0) ? (SPI1WIRE_CMD_TRIPLET | 0x01) : SPI1WIRE_CMD_END;
+			break;
+
+		/**< Koniec rozkazu */
+		case SPI1WIRE_CMD_END >> 4:
+			return 0;
+
+		/**< Nieznany rozkaz (np. uszkodzony stan) - zakoczenie z bdem */
+		default:
+			spi_1wire_error = SPI1WIRE_ERR_STATE;
+			return 0;
+	}
+	spi_1wire_command = command;
+	spi_1wire_next = pattern;
+	spi_1wire_next_action = action;
+	return 1;
+}
+
 ISR(SPI_STC_vect)
 {
-	switch(spi_1wire_command & SPI1WIRE_CMD_READY_MASK)
+	uint8_t action = spi_1wire_action;
+
+	/**< rozpoczcie kolejnej (przygotowanej wczeniej) szczeliny przed analiz
+	     zakoczonej; bufor odbiornika przechowuje bajt zakoczonej szczeliny
+	     do koca kolejnej */
+	if (action & SPI1WIRE_ACT_NEXT) SPDR = spi_1wire_next;
+
+	uint8_t sample = SPDR;
+#if SPI1WIRE_TRACE
+	uint16_t trace_time = TCNT1;
+	uint8_t trace_out = spi_1wire_next;	/**< wany przy SPI1WIRE_ACT_NEXT */
+#endif
+
+#if SPI1WIRE_NESTED_ISR
+	/**< szczelina rozpoczta - odblokowanie przerwa do koca analizy wycznie
+	     dla szczeliny koczcej si stanem wysokim (ostatni bit wzorca, zapis 1
+	     i odczyt): MOSI pozostaje w stanie ostatniego bitu do kolejnego wpisu SPDR,
+	     dlatego opnienie po szczelinie zapisu 0 wyduaoby impuls (tLOW0 maks.
+	     120us, duszy to RESET). Szczeliny zapisu 0, sekwencja RESET i zakoczenie
+	     transakcji obsugiwane s przy zablokowanych przerwaniach. Przerwanie od SPI
+	     blokowane do wyjcia, zgoszone w tym czasie obsugiwane jest po powrocie */
+	uint8_t nested = (action & SPI1WIRE_ACT_NEXT) && (spi_1wire_next & 0x01) &&
+	                 ((spi_1wire_command & SPI1WIRE_CMD) != SPI1WIRE_CMD_RESETPULSE);
+
+	if (nested)
+	{
+		SPCR &= ~(1 << SPIE);
+		SPI1Wire_NestedEnter();
+		sei();
+	}
+#endif
+
+	switch (action & SPI1WIRE_ACT_MASK)
 	{
-		/**< Rozkaz RESET-PULSE */
-		case 0x00:  /**< sekwencja RESET */ 
-		case 0x01:  
-		case 0x02:
-		case 0x03: 
-		case 0x04: 
-		case 0x05:
-		case 0x06:	SPDR = 0x00;
-					spi_1wire_command++;
-					break;
-		case 0x07:  /**< sekwencja PULSE */
-					SPDR = 0xFF;
-					spi_1wire_command++;
-					spi_1wire_data = 0;
-					break;
-		case 0x08:
-		case 0x09:  
-		case 0x0A:  /**< identyfikacja impulsu PRESENCE */
-					if (SPDR == 0) spi_1wire_data++;
-					SPDR = 0xFF;
-					spi_1wire_command++;
-					break;
-		case 0x0B:
-					if (SPDR == 0) spi_1wire_data++;
-					/**< zakoczenie sekwencji, blokada przerwania */
-					spi_1wire_command |= SPI1WIRE_CMD_READY;
-					SPCR &= ~(1 << SPIE);
-					break;
-					
-		/**< Rozkaz READ */
-		case 0x20:
-		case 0x21:
-		case 0x22:
-		case 0x23:
-		case 0x24:
-		case 0x25:
-		case 0x26:
-		case 0x27:	/**< odczyt pojedynczego bitu */
-					if ((SPDR & 0x3F) == 0x3F) spi_1wire_data = (spi_1wire_data >> 1) | 0x80;
-					else spi_1wire_data = (spi_1wire_data >> 1) & 0x7F;
-					/**< wygenerowanie kolejnej sekwencji do odczytu pojedynczego bitu */
-					SPDR = 0x7F;
-					if (spi_1wire_command != 0x27) spi_1wire_command++;
-					else
-					{
-						/**< zakoczenie sekwencji, blokada przerwania */
-						spi_1wire_command |= SPI1WIRE_CMD_READY;
-						SPCR &= ~(1 << SPIE);
-					}
+		case SPI1WIRE_ACT_NONE:
+					break;
+
+		/**< prbki pierwszego bajtu po zwolnieniu magistrali, w ktrych wystpuje
+		     impuls PRESENCE (dla 14,7456MHz ostatni bit - 65us; w trybie overdrive
+		     dwa ostatnie bity - 7,1us i 8,1us) */
+		case SPI1WIRE_ACT_PRESENCE:
+					if ((sample & SPI1WIRE_STD_PRESENCE_MASK) == 0) spi_1wire_presence++;
+					break;
+		case SPI1WIRE_ACT_PRESENCE_OD:
+					if ((sample & SPI1WIRE_OD_PRESENCE_MASK) == 0) spi_1wire_presence++;
 					break;
+
+		/**< diagnostyka magistrali, zapis wszystkich prbek szczeliny */
+		case SPI1WIRE_ACT_CAPTURE:
+		{
+			uint8_t *buffer = spi_1wire_read_buffer;
+
+			*buffer++ = sample;
+			spi_1wire_read_buffer = buffer;
+			break;
+		}
 
-		/**< Rozkaz WRITE */
-		case 0x40:
-		case 0x41:
-		case 0x42:
-		case 0x43:
-		case 0x44:
-		case 0x45:
-		case 0x46:
-		case 0x47:	/**< wysanie pojedynczego bitu */
-					spi_1wire_data = (spi_1wire_data >> 1) & 0x7F;
-					/**< wygenerowanie sekwencji wysyajcej pojedynczy bit */
-					if ((spi_1wire_data & 0x01) == 0) SPDR = 0x00;
-					else SPDR = 0x7F;
-					if (spi_1wire_command != 0x47) spi_1wire_command++;
-					else
-					{
-						/**< zakoczenie sekwencji, blokada przerwania */
-						spi_1wire_command |= SPI1WIRE_CMD_READY;
-						SPCR &= ~(1 << SPIE);
-					}
-					break;
-		
-		/**< Rozkaz nieznany, wstrzymanie transmisji */
-		default:	SPCR &= ~(1 << SPIE);	
+		/**< odczyt bitu, wsuwanego na najstarsz pozycj, wraz z aktualizacj sumy
+		     CRC8 (x^8 + x^5 + x^4 + 1) - wynik dostpny bez ponownego przetwarzania
+		     bufora; obliczenia wykonywane s w trakcie kolejnej szczeliny */
+		case SPI1WIRE_ACT_READ:
+		case SPI1WIRE_ACT_READ_STORE:
+		{
+			uint8_t mask = spi_1wire_read_mask;
+			uint8_t data = spi_1wire_data >> 1;
+			uint8_t crc = spi_1wire_crc;
+
+			if ((sample & mask) == mask)
+			{
+				data |= 0x80;
+				crc ^= 0x01;
+			}
+			if (crc & 0x01) crc = (crc >> 1) ^ 0x8C;
+			else crc >>= 1;
+			spi_1wire_crc = crc;
+			spi_1wire_data = data;
+			if ((action & SPI1WIRE_ACT_MASK) == SPI1WIRE_ACT_READ_STORE)
+			{
+				/**< zapis odczytanego bajtu do bufora */
+				uint8_t *buffer = spi_1wire_read_buffer;
+
+				*buffer++ = data;
+				spi_1wire_read_buffer = buffer;
+			}
+			break;
+		}
+
+		/**< krok przeszukiwania ROM */
+		case SPI1WIRE_ACT_TRIPLET_ID:
+					if ((sample & spi_1wire_read_mask) == spi_1wire_read_mask)
+						spi_1wire_data |= SPI1WIRE_TRIPLET_ID;
+					break;
+		case SPI1WIRE_ACT_TRIPLET_CMP:
+		{
+			uint8_t data = spi_1wire_data;
+
+			if ((sample & spi_1wire_read_mask) == spi_1wire_read_mask) data |= SPI1WIRE_TRIPLET_CMP;
+			if ((data & (SPI1WIRE_TRIPLET_ID | SPI1WIRE_TRIPLET_CMP)) ==
+			    (SPI1WIRE_TRIPLET_ID | SPI1WIRE_TRIPLET_CMP))
+			{
+				/**< brak odpowiedzi ukadw SLAVE, kierunek nie jest wysyany */
+				spi_1wire_data = data;
+				break;
+			}
+			/**< wszystkie ukady zgodne - kierunek zgodny z bitem identyfikatora,
+			     w przeciwnym razie kierunek wybrany przez wywoujcego */
+			if (data & SPI1WIRE_TRIPLET_ID) data |= SPI1WIRE_TRIPLET_DIR;
+			else if (data & SPI1WIRE_TRIPLET_CMP) data &= ~SPI1WIRE_TRIPLET_DIR;
+			spi_1wire_data = data;
+			/**< wysanie kierunku - ostatnia szczelina rozkazu (bez SPI1WIRE_ACT_NEXT,
+			     poza trybem zagniedonym) */
+			if (data & SPI1WIRE_TRIPLET_DIR) SPDR = spi_1wire_pattern_1;
+			else SPDR = SPI1WIRE_PATTERN_0;
+			spi_1wire_action = SPI1WIRE_ACT_NONE;
+			SPI1WIRE_TRACE_RECORD();
+			SPI1WIRE_CAPTURE_RECORD();
+			return;
+		}
+
+		/**< nieznana czynno - przerwanie rozkazu bez kolejnych szczelin,
+		     zadanie oczekujce jest budzone z kodem bdu */
+		default:
+#if SPI1WIRE_NESTED_ISR
+			/**< przywrcenie przerwa przed ewentualnym przeczeniem kontekstu
+			     w SPI1Wire_Complete */
+			cli();
+			if (nested) SPI1Wire_NestedExit();
+#endif
+			spi_1wire_error = SPI1WIRE_ERR_STATE;
+			SPI1WIRE_TRACE_RECORD();
+			SPI1WIRE_CAPTURE_RECORD();
+			SPI1Wire_Complete();
+			return;
+	}
+	SPI1WIRE_TRACE_RECORD();
+	SPI1WIRE_CAPTURE_RECORD();
+
+	if (action & SPI1WIRE_ACT_NEXT)
+	{
+		/**< rozpoczta szczelina staje si biec, wyznaczenie kolejnej */
+		action = spi_1wire_next_action;
+		if (SPI1Wire_Produce()) action |= SPI1WIRE_ACT_NEXT;
+		spi_1wire_action = action;
+	}
+	else
+	{
+		/**< zakoczenie sekwencji, blokada przerwania; po ostatniej szczelinie
+		     nie jest generowana kolejna, ktra kolidowaaby z pierwsz szczelin
+		     nastpnego rozkazu */
+		SPI1Wire_Complete();
 	}
+#if SPI1WIRE_NESTED_ISR
+	if (nested)
+	{
+		/**< zgoszenia przerwa odblokowanych ponownie obsugiwane s po powrocie
+		     (reti), poza programem obsugi przerwania od SPI */
+		cli();
+		SPCR |= (1 << SPIE);
+		SPI1Wire_NestedExit();
+	}
+#endif
+}
+
+/**< bity SPCR wymagane do generowania sekwencji (SPE, MSTR), bit MSTR zerowany jest
+     sprztowo przy stanie niskim na wejciu SS */
+#define SPI1WIRE_SPCR_MODE		((1 << SPE) | (1 << MSTR))
+
+/**
+  * Wyciszenie interfejsu SPI i przywrcenie stanu pocztkowego automatu
+  *
+  * Przerwanie od SPI musi by zablokowane. Oczekiwanie na koniec bajtu
+  * w trakcie transmisji (najwyej jedna szczelina), wysanie bajtu 0xFF
+  * zwalniajcego magistral (MOSI pozostaje w stanie ostatniego bitu, np. po
+  * przerwanej sekwencji RESET), przywrcenie konfiguracji SPCR/SPSR dla
+  * biecej prdkoci; oczekiwanie na SPIF ograniczone licznikiem.
+  */
+static void SPI1Wire_Quiesce(void)
+{
+	uint16_t timeout;
+
+	SPI1WIRE_STRONG_PULLUP_OFF();
+	SPCR = SPI1WIRE_SPCR_MODE;
+	SPI1Wire_SetSpeed(spi_1wire_speed);
+	(void)SPSR;
+	(void)SPDR;
+	SPDR = 0xFF;
+	if (SPSR & (1 << WCOL))
+	{
+		/**< bajt w trakcie transmisji, wpis zignorowany */
+		timeout = 0;
+		while (((SPSR & (1 << SPIF)) == 0) && (--timeout != 0))
+		{
+		};
+		(void)SPDR;
+		SPDR = 0xFF;
+	}
+	timeout = 0;
+	while (((SPSR & (1 << SPIF)) == 0) && (--timeout != 0))
+	{
+	};
+	(void)SPDR;
+	spi_1wire_action = SPI1WIRE_ACT_NONE;
+	spi_1wire_flags = 0;
+	spi_1wire_length = 0;
+	spi_1wire_read_length = 0;
+}
+
+/**
+  * Oczekiwanie na zakoczenie sekwencji rozpocztej przez funkcje biblioteki
+  *
+  * W trybie SPI1WIRE_USE_FREERTOS zadanie jest blokowane do chwili zwolnienia
+  * semafora w programie obsugi przerwania ISR, procesor jest w tym czasie
+  * dostpny dla pozostaych zada (reset to ok. 0,8ms, bajt ok. 0,55ms;
+  * w trybie overdrive ok. 0,1ms i 0,07ms).
+  * Czas oczekiwania ograniczony jest do czasu wszystkich szczelin rozkazu
+  * powikszonego o SPI1WIRE_TIMEOUT_MARGIN_MS; po jego upywie (np. utracone
+  * przerwanie, zmieniona konfiguracja SPCR) interfejs jest wyciszany.
+  *
+  * @param  slots maksymalna liczba szczelin rozkazu
+  * @return SPI1WIRE_ERR_xxx
+  */
+static uint8_t SPI1Wire_Wait(uint32_t slots)
+{
+	uint32_t timeout = slots * SPI1WIRE_SLOT_US_MAX / 1000 + 1 + SPI1WIRE_TIMEOUT_MARGIN_MS; /**< [ms] */
+
+#if SPI1WIRE_USE_FREERTOS
+	uint32_t ticks = timeout / portTICK_RATE_MS + 1;
+
+	if (ticks >= portMAX_DELAY) ticks = portMAX_DELAY - 1;
+	if (xSemaphoreTake(spi_1wire_ready, (portTickType)ticks) == pdTRUE) return spi_1wire_error;
+#else
+	timeout *= 100;
+	while ((spi_1wire_command & SPI1WIRE_CMD_READY) == 0)
+	{
+		if (timeout-- == 0) break;
+		_delay_us(10);
+	}
+	if (spi_1wire_command & SPI1WIRE_CMD_READY) return spi_1wire_error;
+#endif
+	/**< przekroczony czas - zablokowanie przerwania i wyciszenie interfejsu */
+	uint8_t sreg = SREG;
+
+	cli();
+	SPCR &= ~(1 << SPIE);
+	SREG = sreg;
+	spi_1wire_error = ((SPCR & SPI1WIRE_SPCR_MODE) != SPI1WIRE_SPCR_MODE) ?
+	                  SPI1WIRE_ERR_MODE : SPI1WIRE_ERR_TIMEOUT;
+	SPI1Wire_Quiesce();
+	spi_1wire_command = SPI1WIRE_CMD_READY | SPI1WIRE_CMD_END;
+#if SPI1WIRE_USE_FREERTOS
+	/**< semafor mg zosta zwolniony po upywie czasu, przed zablokowaniem przerwania */
+	xSemaphoreTake(spi_1wire_ready, 0);
+#endif
+	return spi_1wire_error;
+}
+
+/**
+  * Rozpoczcie rozkazu opisanego przez spi_1wire_command i oczekiwanie na jego
+  * zakoczenie
+  *
+  * Przed odblokowaniem przerwania wyznaczane s dwie pierwsze szczeliny: pierwsza
+  * wysyana jest bezporednio, druga oczekuje w spi_1wire_next na program obsugi
+  * przerwania. Rozkaz musi obejmowa co najmniej jedn szczelin.
+  *
+  * @param  slots maksymalna liczba szczelin rozkazu (wyznaczenie czasu oczekiwania)
+  * @return SPI1WIRE_ERR_xxx
+  */
+static uint8_t SPI1Wire_Start(uint32_t slots)
+{
+	uint8_t first, action;
+
+	spi_1wire_crc = 0;
+	spi_1wire_error = SPI1WIRE_ERR_NONE;
+	if ((SPCR & SPI1WIRE_SPCR_MODE) != SPI1WIRE_SPCR_MODE)
+	{
+		/**< konfiguracja interfejsu zmieniona poza bibliotek - przywrcenie,
+		     rozkaz nie jest wykonywany */
+		SPI1Wire_Quiesce();
+		spi_1wire_command = SPI1WIRE_CMD_READY | SPI1WIRE_CMD_END;
+		spi_1wire_error = SPI1WIRE_ERR_MODE;
+		return spi_1wire_error;
+	}
+	SPI1Wire_Produce();
+	first = spi_1wire_next;
+	action = spi_1wire_next_action;
+	if (SPI1Wire_Produce()) action |= SPI1WIRE_ACT_NEXT;
+	spi_1wire_action = action;
+	/**< odblokowanie przerwania od interfejsu SPI i wysanie pierwszej szczeliny */
+	SPCR |= (1 << SPIE);
+	SPDR = first;
+	/**< oczekiwanie na zakoczenie wszystkich szczelin */
+	return SPI1Wire_Wait(slots);
+}
+
+void SPI1Wire_Abort(void)
+{
+	uint8_t sreg = SREG;
+	uint8_t pending;
+
+	cli();
+	pending = (spi_1wire_command & SPI1WIRE_CMD_READY) == 0;
+	SPCR &= ~(1 << SPIE);
+	SREG = sreg;
+	if (!pending) return;
+
+	SPI1Wire_Quiesce();
+	spi_1wire_error = SPI1WIRE_ERR_ABORTED;
+	spi_1wire_command = SPI1WIRE_CMD_READY | SPI1WIRE_CMD_END;
+#if SPI1WIRE_USE_FREERTOS
+	/**< zwolnienie zadania oczekujcego na zakoczenie rozkazu */
+	xSemaphoreGive(spi_1wire_ready);
+#endif
+}
+
+uint8_t SPI1Wire_GetError(void)
+{
+	return spi_1wire_error;
+}
+
+/**
+  * Przygotowanie rozkazu jednofazowego (bez sekwencji RESET i fazy odczytu)
+  */
+static inline void SPI1Wire_Prepare(uint8_t *buffer, uint16_t length)
+{
+	SPI1WIRE_STRONG_PULLUP_OFF();
+	spi_1wire_flags = 0;
+	spi_1wire_buffer = buffer;
+	spi_1wire_length = length;
+	spi_1wire_read_buffer = buffer;
+	spi_1wire_read_length = 0;
+	/**< rozkaz warstwy ROM wysyany pojedynczymi bitami nie jest ledzony */
+	if (spi_1wire_rom_phase) spi_1wire_selected_valid = 0;
+	spi_1wire_rom_phase = 0;
+}
+
+/**
+  * ledzenie ukadu wybranego rozkazem warstwy ROM (pierwszy bajt zapisu po
+  * sekwencji RESET)
+  *
+  * Identyfikator wysany rozkazem Match ROM jest zapamitywany; ponowny wybr
+  * tego samego ukadu z rodziny SPI1WIRE_RESUME_FAMILY moe zosta zastpiony
+  * rozkazem Resume. Pozostae rozkazy (poza Resume) kasuj znacznik RC we
+  * wszystkich ukadach.
+  *
+  * @return 0 - blok wysyany bez zmian, w przeciwnym razie Match ROM
+  *         z identyfikatorem zastpowany jest rozkazem Resume
+  */
+static uint8_t SPI1Wire_TrackRom(const uint8_t *write, uint16_t length)
+{
+	if ((write[0] == SPI1WIRE_ROM_MATCH) && (length > SPI1WIRE_ROM_SIZE))
+	{
+		if (spi_1wire_selected_valid &&
+		    (memcmp(&write[1], spi_1wire_selected, SPI1WIRE_ROM_SIZE) == 0))
+			return 1;
+		memcpy(spi_1wire_selected, &write[1], SPI1WIRE_ROM_SIZE);
+		spi_1wire_selected_valid = SPI1WIRE_RESUME_FAMILY(write[1]);
+	}
+	else if (write[0] != SPI1WIRE_ROM_RESUME) spi_1wire_selected_valid = 0;
+	return 0;
+}
+
+void SPI1Wire_ResumeClear(void)
+{
+	spi_1wire_selected_valid = 0;
 }
 
+uint8_t SPI1Wire_Execute(const SPI1Wire_Transaction *transaction)
+{
+	uint8_t rom_phase = (transaction->flags & SPI1WIRE_TR_RESET) || spi_1wire_rom_phase;
+
+	/**< zwolnienie magistrali podtrzymywanej po poprzedniej transakcji */
+	SPI1WIRE_STRONG_PULLUP_OFF();
+	/**< opis kolejnych faz transakcji, wykonywanych w programie obsugi przerwania */
+	spi_1wire_flags = transaction->flags;
+	spi_1wire_buffer = (uint8_t *)transaction->write; /**< bufor wycznie odczytywany */
+	spi_1wire_length = transaction->write_length;
+	spi_1wire_read_buffer = transaction->read;
+	spi_1wire_read_length = transaction->read_length;
+	spi_1wire_presence = SPI1WIRE_NO_PRESENCE;
+	/**< transakcja zawierajca wycznie sekwencj RESET - rozkaz warstwy ROM
+	     w kolejnej transakcji */
+	spi_1wire_rom_phase = (transaction->flags & SPI1WIRE_TR_RESET) &&
+	                      (spi_1wire_length == 0) && (spi_1wire_read_length == 0);
+	if (spi_1wire_length != 0)
+	{
+		spi_1wire_shift = *spi_1wire_buffer;
+		if (rom_phase && SPI1Wire_TrackRom(transaction->write, spi_1wire_length))
+		{
+			/**< Resume zamiast Match ROM, bufor wskazuje ostatni bajt identyfikatora,
+			     kolejne bajty pobierane s jak po pierwszym bajcie bloku */
+			spi_1wire_shift = SPI1WIRE_ROM_RESUME;
+			spi_1wire_buffer += SPI1WIRE_ROM_SIZE;
+			spi_1wire_length -= SPI1WIRE_ROM_SIZE;
+		}
+	}
+	/**< pierwsza zdefiniowana faza, kolejne uruchamiane s w programie obsugi
+	     przerwania ISR */
+	if (transaction->flags & SPI1WIRE_TR_RESET)
+	{
+		if (spi_1wire_speed == SPI1WIRE_SPEED_OVERDRIVE)
+			spi_1wire_command = SPI1WIRE_CMD_RESETPULSE_OD;
+		else spi_1wire_command = SPI1WIRE_CMD_RESETPULSE;
+	}
+	else if (spi_1wire_length != 0) spi_1wire_command = SPI1WIRE_CMD_WRITE;
+	else if (spi_1wire_read_length != 0) spi_1wire_command = SPI1WIRE_CMD_READ;
+	else
+	{
+		/**< transakcja pusta */
+		return !SPI1WIRE_NO_PRESENCE;
+	}
+	if (SPI1Wire_Start(SPI1WIRE_RESET_BYTES_MAX + 8UL * (transaction->write_length +
+	                   (uint32_t)transaction->read_length)) != SPI1WIRE_ERR_NONE)
+	{
+		/**< stan ukadw SLAVE nieznany */
+		spi_1wire_selected_valid = 0;
+		return SPI1WIRE_NO_PRESENCE;
+	}
+	if (transaction->flags & SPI1WIRE_TR_RESET)
+	{
+		/**< brak odpowiedzi - rozkaz warstwy ROM nie zosta wysany */
+		if (spi_1wire_presence == SPI1WIRE_NO_PRESENCE) spi_1wire_selected_valid = 0;
+		if ((spi_1wire_presence == SPI1WIRE_NO_PRESENCE) &&
+		    (spi_1wire_speed == SPI1WIRE_SPEED_OVERDRIVE))
+		{
+			/**< brak ukadw pracujcych w trybie overdrive - powrt do prdkoci
+			     standardowej, standardowa sekwencja RESET przywraca j rwnie
+			     w ukadach SLAVE */
+			SPI1Wire_SetSpeed(SPI1WIRE_SPEED_STANDARD);
+			return SPI1Wire_Execute(transaction);
+		}
+		return spi_1wire_presence;
+	}
+	return !SPI1WIRE_NO_PRESENCE;
+}
+
+void SPI1Wire_SetSpeed(uint8_t speed)
+{
+	SPCR &= ~((1 << SPR1) | (1 << SPR0));
+	SPSR &= ~(1 << SPI2X);
+#if SPI1WIRE_OVERDRIVE
+	if (speed == SPI1WIRE_SPEED_OVERDRIVE)
+	{
+		/**< dla 14,7456MHz dzielnik 16: impuls zapisu 1 i odczytu 1,09us (dopuszczalne
+		     1..2us), zapisu 0 8,68us (6..16us); prbka odczytu w drugim bicie, 1,6us */
+		SPCR |= SPI1WIRE_OD_SPCR;
+		SPSR |= SPI1WIRE_OD_SPSR;
+		spi_1wire_read_mask = spi_1wire_od_mask;
+		spi_1wire_pattern_1 = SPI1WIRE_OD_PATTERN_1;
+		spi_1wire_speed = SPI1WIRE_SPEED_OVERDRIVE;
+		return;
+	}
+#else
+	(void)speed;
+#endif
+	/**< jak po SPI1Wire_Init */
+	SPCR |= SPI1WIRE_STD_SPCR;
+	SPSR |= SPI1WIRE_STD_SPSR;
+	spi_1wire_read_mask = spi_1wire_std_mask;
+	spi_1wire_pattern_1 = SPI1WIRE_STD_PATTERN_1;
+	spi_1wire_speed = SPI1WIRE_SPEED_STANDARD;
+}
+
+uint8_t SPI1Wire_GetSpeed(void)
+{
+	return spi_1wire_speed;
+}
+
+void SPI1Wire_SetReadMask(uint8_t mask)
+{
+#if SPI1WIRE_OVERDRIVE
+	if (spi_1wire_speed == SPI1WIRE_SPEED_OVERDRIVE)
+	{
+		if (mask == 0) mask = SPI1WIRE_OD_READ_MASK;
+		spi_1wire_od_mask = mask;
+		spi_1wire_read_mask = mask;
+		return;
+	}
+#endif
+	if (mask == 0) mask = SPI1WIRE_STD_READ_MASK;
+	spi_1wire_std_mask = mask;
+	spi_1wire_read_mask = mask;
+}
+
+uint8_t SPI1Wire_GetReadMask(void)
+{
+	return spi_1wire_read_mask;
+}
+
+uint8_t SPI1Wire_Calibrate(void)
+{
+	uint8_t ones = 0xFF;	/**< bity o stanie wysokim we wszystkich szczelinach 1 */
+	uint8_t zeros = 0x00;	/**< bity o stanie wysokim w dowolnej szczelinie 0 */
+	uint8_t count_1 = 0, count_0 = 0;
+	uint8_t mask;
+
+	if (SPI1Wire_ResetPresence() == SPI1WIRE_NO_PRESENCE) return 0;
+	SPI1Wire_Write(SPI1WIRE_ROM_SEARCH);
+
+	for (uint8_t bit = 0; bit < 64; bit++)
+	{
+		uint8_t raw[2];	/**< prbki szczelin bitu identyfikatora i dopenienia */
+		uint8_t direction = 0;
+
+		/**< dwie szczeliny odczytu, zapisywane bez decyzji o wartoci bitu */
+		SPI1Wire_Prepare(raw, 0);
+		spi_1wire_flags = SPI1WIRE_TR_CAPTURE;
+		spi_1wire_read_length = 1;
+		spi_1wire_command = SPI1WIRE_CMD_READ | 0x06;
+		if (SPI1Wire_Start(2) != SPI1WIRE_ERR_NONE) return 0;
+
+		/**< w szczelinie 0 magistrala utrzymywana jest w stanie niskim duej,
+		     jej prbki o stanie wysokim s podzbiorem prbek szczeliny 1; szczeliny
+		     rwne (niejednoznaczno lub brak odpowiedzi) oraz nieporwnywalne
+		     (zakcenia) s pomijane, przeszukiwanie kontynuowane jest gazi 0 */
+		if (raw[0] != raw[1])
+		{
+			uint8_t index_1;
+
+			if ((raw[0] & ~raw[1]) == 0) index_1 = 1;
+			else if ((raw[1] & ~raw[0]) == 0) index_1 = 0;
+			else index_1 = 2;
+			if (index_1 < 2)
+			{
+				ones &= raw[index_1];
+				zeros |= raw[index_1 ^ 1];
+				count_1++;
+				count_0++;
+				/**< ukady zgodne: kierunek rwny bitowi identyfikatora */
+				direction = (index_1 == 0);
+			}
+		}
+		SPI1Wire_WriteBit(direction);
+	}
+
+	/**< maska: bity rozrniajce wszystkie zarejestrowane szczeliny 1 i 0 */
+	mask = ones & ~zeros;
+	if ((count_1 < SPI1WIRE_CALIBRATE_MIN) || (count_0 < SPI1WIRE_CALIBRATE_MIN) || (mask == 0))
+		return 0;
+	SPI1Wire_SetReadMask(mask);
+	return mask;
+}
+
+#if SPI1WIRE_OVERDRIVE
+/**
+  * Sekwencja RESET i rozkaz przeczajcy ukady w tryb overdrive, wysyane
+  * z prdkoci standardow; po odpowiedzi ukadw wybierana jest prdko overdrive
+  */
+static uint8_t SPI1Wire_Overdrive(uint8_t command)
+{
+	const SPI1Wire_Transaction select = { SPI1WIRE_TR_RESET, &command, 1, NULL, 0 };
+
+	SPI1Wire_SetSpeed(SPI1WIRE_SPEED_STANDARD);
+	if (SPI1Wire_Execute(&select) == SPI1WIRE_NO_PRESENCE) return SPI1WIRE_NO_PRESENCE;
+	SPI1Wire_SetSpeed(SPI1WIRE_SPEED_OVERDRIVE);
+	return !SPI1WIRE_NO_PRESENCE;
+}
+
+uint8_t SPI1Wire_OverdriveSkip(void)
+{
+	return SPI1Wire_Overdrive(SPI1WIRE_ROM_OVERDRIVE_SKIP);
+}
+
+uint8_t SPI1Wire_OverdriveMatch(const uint8_t *rom)
+{
+	if (SPI1Wire_Overdrive(SPI1WIRE_ROM_OVERDRIVE_MATCH) == SPI1WIRE_NO_PRESENCE)
+		return SPI1WIRE_NO_PRESENCE;
+	/**< identyfikator wysyany ju z prdkoci overdrive */
+	SPI1Wire_WriteBlock(rom, SPI1WIRE_ROM_SIZE);
+	return !SPI1WIRE_NO_PRESENCE;
+}
+#endif
+
 uint8_t SPI1Wire_ResetPresence(void)
 {
-	/**< wybr rozkazu */
-	spi_1wire_command = SPI1WIRE_CMD_RESETPULSE;
-	/**< odblokowanie przerwania od interfejsu SPI */
-	SPCR |= (1 << SPIE);
-	/**< rozpoczcie transmisji, po zakoczeniu wywoywany jest program obsugi przerwania ISR */
-	SPDR = 0x00;
-	/**< oczekiwania na zakoczenie sekwencji */
-	while((spi_1wire_command & SPI1WIRE_CMD_READY) == 0)
-	{
-		/**< @todo opracowa wersj nieblokujc */
-	};
-	return spi_1wire_data;
+	const SPI1Wire_Transaction reset = { SPI1WIRE_TR_RESET, NULL, 0, NULL, 0 };
+
+	return SPI1Wire_Execute(&reset);
 }
 
+uint8_t SPI1Wire_ResetDiagnostic(SPI1Wire_Diagnostic *diag)
+{
+	uint8_t od = (spi_1wire_speed == SPI1WIRE_SPEED_OVERDRIVE);
+	uint8_t command = od ? SPI1WIRE_CMD_RESETPULSE_OD : SPI1WIRE_CMD_RESETPULSE;
+	uint8_t low = od ? SPI1WIRE_OD_RESET_BYTES : SPI1WIRE_STD_RESET_BYTES;
+	uint8_t high = od ? SPI1WIRE_OD_RSTH_BYTES : SPI1WIRE_STD_RSTH_BYTES;
+	uint16_t bit_ns = od ? SPI1WIRE_OD_BIT_NS : SPI1WIRE_STD_BIT_NS;
+	uint16_t rise_ns = od ? SPI1WIRE_OD_RISE_NS : SPI1WIRE_STD_RISE_NS;
+	uint8_t start = SPI1WIRE_DIAG_NONE;
+	uint8_t width = 0;
+
+	diag->length = 0;
+	diag->bit_ns = bit_ns;
+	diag->presence_start = SPI1WIRE_DIAG_NONE;
+	diag->presence_width = 0;
+
+	/**< stan magistrali przed sekwencj RESET: licznik ustawiony na ostatni bajt
+	     obserwacji - generowana jest jedna szczelina 0xFF; brak impulsu PRESENCE
+	     koczy rozkaz */
+	SPI1Wire_Prepare(&diag->idle, 0);
+	spi_1wire_flags = SPI1WIRE_TR_CAPTURE;
+	spi_1wire_presence = SPI1WIRE_NO_PRESENCE;
+	spi_1wire_command = command | (low + high - 1);
+	if (SPI1Wire_Start(1) != SPI1WIRE_ERR_NONE) return SPI1WIRE_DIAG_FAULT;
+	diag->recovered = (diag->idle & 0x01) != 0;
+	if (diag->idle == 0x00) return SPI1WIRE_DIAG_SHORT;
+
+	/**< sekwencja RESET-PULSE z zapisem wszystkich bajtw obserwacji */
+	spi_1wire_read_buffer = diag->samples;
+	spi_1wire_command = command;
+	if (SPI1Wire_Start(low + high) != SPI1WIRE_ERR_NONE) return SPI1WIRE_DIAG_FAULT;
+	diag->length = high;
+	/**< kolejny zapis rozpoczyna si rozkazem warstwy ROM */
+	spi_1wire_rom_phase = 1;
+
+	/**< impuls PRESENCE - pierwszy cig prbek o stanie niskim; prbki przypadajce
+	     w czasie narastania zbocza po zwolnieniu magistrali s pomijane */
+	for (uint8_t i = 0; i < high * 8; i++)
+	{
+		uint8_t level = diag->samples[i >> 3] & (0x80 >> (i & 0x07));
+
+		if ((uint32_t)(2 * i + 1) * bit_ns < 2UL * rise_ns) continue;
+		if (level == 0)
+		{
+			if (start == SPI1WIRE_DIAG_NONE) start = i;
+			width++;
+		}
+		else if (start != SPI1WIRE_DIAG_NONE) break;
+	}
+	diag->presence_start = start;
+	diag->presence_width = width;
+	diag->recovered = (diag->samples[high - 1] & 0x01) != 0;
+
+	if (!diag->recovered) return SPI1WIRE_DIAG_STUCK_LOW;
+	if (start == SPI1WIRE_DIAG_NONE) return SPI1WIRE_DIAG_NO_PRESENCE;
+
+	/**< wymagania czasowe z tolerancj jednego bitu (rozdzielczo prbkowania):
+	     pocztek impulsu w przedziale <tPDH min, tPDH max>, czas trwania co najmniej
+	     tPDL min */
+	uint32_t start_ns = (uint32_t)start * bit_ns;
+	uint32_t width_ns = (uint32_t)(width + 1) * bit_ns;
+
+	if (od)
+	{
+		if ((start_ns + bit_ns < SPI1WIRE_OD_PDH_MIN_NS) || (start_ns > SPI1WIRE_OD_PDH_MAX_NS) ||
+		    (width_ns < SPI1WIRE_OD_PDL_MIN_NS))
+			return SPI1WIRE_DIAG_TIMING;
+	}
+	else
+	{
+		if ((start_ns + bit_ns < SPI1WIRE_STD_PDH_MIN_NS) || (start_ns > SPI1WIRE_STD_PDH_MAX_NS) ||
+		    (width_ns < SPI1WIRE_STD_PDL_MIN_NS))
+			return SPI1WIRE_DIAG_TIMING;
+	}
+	return SPI1WIRE_DIAG_OK;
+}
+
 void SPI1Wire_Write(uint8_t byte)
 {
-	/**< dana do wysania */
-	spi_1wire_data = byte;
-	/**< wybr rozkazu */
-	spi_1wire_command = SPI1WIRE_CMD_WRITE;
-	/**< odblokowanie przerwania od interfejsu SPI */
-	SPCR |= (1 << SPIE);
-	/**< rozpoczcie transmisji, wyslanie pierwszej sekwencji (bitu),
-	     po zakoczeniu wywoywany jest program obsugi przerwania ISR */
-	if ((spi_1wire_data & 0x01) == 0x00) SPDR = 0x00; else SPDR = 0x7F;
-	/**< oczekiwania na zakoczenie sekwencji wysyania wszystkich bitw */
-	while((spi_1wire_command & SPI1WIRE_CMD_READY) == 0)
-	{
-		/**< @todo opracowa wersj nieblokujc */
-	};
+	SPI1Wire_WriteBlock(&byte, 1);
+}
+
+uint8_t SPI1Wire_Read(void)
+{
+	uint8_t byte;
+
+	SPI1Wire_ReadBlock(&byte, 1);
+	return byte;
+}
+
+void SPI1Wire_WriteBlock(const uint8_t *buffer, uint16_t length)
+{
+	const SPI1Wire_Transaction write = { 0, buffer, length, NULL, 0 };
+
+	SPI1Wire_Execute(&write);
 }
 
-uint8_t SPI1Wire_Read(void)
+void SPI1Wire_ReadBlock(uint8_t *buffer, uint16_t length)
 {
-	/**< wybr rozkazu */
-	spi_1wire_command = SPI1WIRE_CMD_READ;
-	/**< odblokowanie przerwania od interfejsu SPI */
-	SPCR |= (1 << SPIE);
-	/**< rozpoczcie transmisji, po zakoczeniu wywoywany jest program
-	     obsugi przerwania ISR, w ktrym odczytywane bd kolejne bity */
-	SPDR = 0x7F;
-	/**< oczekiwania na zakoczenie sekwencji wysyania wszystkich bitw */
-	while((spi_1wire_command & SPI1WIRE_CMD_READY) == 0)
-	{
-		/**< @todo opracowa wersj nieblokujc */
-	};
-	return spi_1wire_data;
+	const SPI1Wire_Transaction read = { 0, NULL, 0, buffer, length };
+
+	SPI1Wire_Execute(&read);
 }
+
+void SPI1Wire_TouchBlock(uint8_t *buffer, uint16_t length)
+{
+	if (length == 0) return;
+	/**< odczytane bajty zapisywane s w miejsce wysanych */
+	SPI1Wire_Prepare(buffer, length);
+	spi_1wire_shift = *buffer;
+	spi_1wire_command = SPI1WIRE_CMD_TOUCH;
+	SPI1Wire_Start(8UL * length);
+}
+
+void SPI1Wire_WriteBit(uint8_t bit)
+{
+	uint8_t byte = (bit != 0);
+
+	SPI1Wire_Prepare(&byte, 1);
+	spi_1wire_shift = byte;
+	/**< licznik bitw ustawiony na ostatni bit bajtu - generowana jest jedna szczelina */
+	spi_1wire_command = SPI1WIRE_CMD_WRITE | 0x07;
+	SPI1Wire_Start(1);
+}
+
+uint8_t SPI1Wire_ReadBit(void)
+{
+	uint8_t byte = 0xFF;	/**< w przypadku bdu - stan magistrali bez odpowiedzi */
+
+	SPI1Wire_Prepare(&byte, 0);
+	spi_1wire_read_length = 1;
+	/**< licznik bitw ustawiony na ostatni bit bajtu, odczytany bit
+	     zapisywany jest na najstarszej pozycji */
+	spi_1wire_command = SPI1WIRE_CMD_READ | 0x07;
+	SPI1Wire_Start(1);
+	return byte >> 7;
+}
+
+uint8_t SPI1Wire_Triplet(uint8_t direction)
+{
+	SPI1Wire_Prepare(NULL, 0);
+	/**< kierunek wybierany w przypadku niejednoznacznoci */
+	spi_1wire_data = (direction != 0) ? SPI1WIRE_TRIPLET_DIR : 0;
+	spi_1wire_command = SPI1WIRE_CMD_TRIPLET;
+	if (SPI1Wire_Start(3) != SPI1WIRE_ERR_NONE)
+		return SPI1WIRE_TRIPLET_ID | SPI1WIRE_TRIPLET_CMP;	/**< jak brak ukadw */
+	return spi_1wire_data;
+}
+
+#if SPI1WIRE_SEARCH_TRIPLET
+#define SPI1Wire_SearchTriplet	SPI1Wire_Triplet
+#else
+/**
+  * Krok przeszukiwania ROM realizowany trzema niezalenymi rozkazami,
+  * wynik zgodny z SPI1Wire_Triplet
+  */
+static uint8_t SPI1Wire_SearchTriplet(uint8_t direction)
+{
+	uint8_t result = 0;
+
+	if (SPI1Wire_ReadBit() != 0) result |= SPI1WIRE_TRIPLET_ID;
+	if (SPI1Wire_ReadBit() != 0) result |= SPI1WIRE_TRIPLET_CMP;
+	if (result == (SPI1WIRE_TRIPLET_ID | SPI1WIRE_TRIPLET_CMP)) return result;
+	if (result & SPI1WIRE_TRIPLET_ID) direction = 1;
+	else if (result & SPI1WIRE_TRIPLET_CMP) direction = 0;
+	SPI1Wire_WriteBit(direction);
+	if (direction != 0) result |= SPI1WIRE_TRIPLET_DIR;
+	return result;
+}
+#endif
+
+/**
+  * Wyszukanie kolejnego ukadu SLAVE, algorytm wg Maxim AN187
+  */
+static uint8_t SPI1Wire_SearchRom(SPI1Wire_Search *search)
+{
+	uint8_t last_zero = 0;
+
+	if (search->last_device) return 0;
+
+	if (SPI1Wire_ResetPresence() == SPI1WIRE_NO_PRESENCE)
+	{
+		search->last_discrepancy = 0;
+		return 0;
+	}
+	SPI1Wire_Write(SPI1WIRE_ROM_SEARCH);
+
+	for (uint8_t bit = 1; bit <= 64; bit++)
+	{
+		uint8_t *byte = &search->rom[(bit - 1) >> 3];
+		uint8_t mask = 1 << ((bit - 1) & 0x07);
+		uint8_t direction;
+
+		/**< przed ostatni niejednoznacznoci powtarzana jest poprzednia cieka,
+		     na jej pozycji wybierana jest ga 1, za ni ga 0 */
+		if (bit < search->last_discrepancy) direction = ((*byte & mask) != 0);
+		else direction = (bit == search->last_discrepancy);
+
+		uint8_t result = SPI1Wire_SearchTriplet(direction);
+
+		if (result == (SPI1WIRE_TRIPLET_ID | SPI1WIRE_TRIPLET_CMP))
+		{
+			/**< brak odpowiedzi, ukad odczony w trakcie przeszukiwania */
+			search->last_discrepancy = 0;
+			return 0;
+		}
+		if ((result & (SPI1WIRE_TRIPLET_ID | SPI1WIRE_TRIPLET_CMP | SPI1WIRE_TRIPLET_DIR)) == 0)
+			last_zero = bit;
+
+		if (result & SPI1WIRE_TRIPLET_DIR) *byte |= mask;
+		else *byte &= ~mask;
+	}
+
+	search->last_discrepancy = last_zero;
+	if (last_zero == 0) search->last_device = 1;
+
+	return SPI1Wire_CRC8(search->rom, SPI1WIRE_ROM_SIZE) == 0;
+}
+
+uint8_t SPI1Wire_SearchFirst(SPI1Wire_Search *search)
+{
+	search->last_discrepancy = 0;
+	search->last_device = 0;
+	return SPI1Wire_SearchRom(search);
+}
+
+uint8_t SPI1Wire_SearchNext(SPI1Wire_Search *search)
+{
+	return SPI1Wire_SearchRom(search);
+}
+
+uint8_t SPI1Wire_GetCRC8(void)
+{
+	return spi_1wire_crc;
+}
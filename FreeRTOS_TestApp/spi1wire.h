@@ -13,7 +13,157 @@
 #include <avr/io.h>
 #include <avr/interrupt.h>
 
-/** 
+/**< konfiguracja projektu (wyprowadzenie silnego podcigania) */
+#include "main.h"
+/**< suma kontrolna CRC8 */
+#include "onewire_crc.h"
+
+/**
+  * @def SPI1WIRE_USE_FREERTOS
+  *
+  * Sposb oczekiwania na zakoczenie sekwencji interfejsu 1-Wire:
+  * - 1 - zadanie wywoujce funkcj biblioteki jest blokowane na semaforze
+  *       systemu FreeRTOS, program obsugi przerwania ISR zwalnia semafor
+  *       (xSemaphoreGiveFromISR) po zakoczeniu sekwencji; w tym czasie
+  *       procesor wykonuje pozostae zadania,
+  * - 0 - aktywne oczekiwanie w ptli (wersja bez systemu operacyjnego).
+  *
+  * @note W trybie FreeRTOS funkcje biblioteki (poza SPI1Wire_Init) mog by
+  *       wywoywane wycznie z zada, po uruchomieniu planisty.
+  */
+#ifndef SPI1WIRE_USE_FREERTOS
+#define SPI1WIRE_USE_FREERTOS		1
+#endif
+
+/**
+  * @def SPI1WIRE_NESTED_ISR
+  *
+  * Obsuga przerwa w trakcie programu obsugi przerwania od SPI:
+  * - 0 - program obsugi przerwania wykonywany jest w caoci przy zablokowanych
+  *       przerwaniach, przerwanie taktu systemu (Timer1) opniane jest
+  *       o czas jego wykonania, a duga obsuga taktu opnia kolejn szczelin,
+  * - 1 - po wpisaniu do SPDR szczeliny zapisu 1 lub odczytu (przebieg generowany
+  *       jest sprztowo, po jego zakoczeniu MOSI pozostaje w stanie wysokim)
+  *       przerwanie od SPI jest blokowane (SPIE), a przerwania globalnie
+  *       odblokowywane na czas analizy szczeliny i wyznaczania nastpnej;
+  *       opnienie innych przerwa ograniczone jest do wejcia do programu
+  *       obsugi przerwania i wpisu SPDR (ok. 40 taktw zegara, 3us dla
+  *       14,7456MHz). Jak w trybie 0 obsugiwane s szczeliny zapisu 0 (MOSI
+  *       w stanie niskim do kolejnego wpisu SPDR - opnienie wyduaoby impuls
+  *       ponad tLOW0 maks. 120us), sekwencja RESET oraz zakoczenie transakcji
+  *       (silne podciganie w cigu 10us, zwolnienie semafora).
+  *       Przerwania, ktrych programy obsugi mog przeczy kontekst (takt
+  *       systemu, zwolnienie semafora), pozostaj w tym czasie zablokowane
+  *       (SPI1WIRE_NESTED_TIMSK, SPI1WIRE_NESTED_UCSRB) - przeczenie wewntrz
+  *       programu obsugi przerwania od SPI wstrzymaoby szczelin na czas pracy
+  *       innego zadania. Opnienie taktu systemu jest wic takie jak w trybie 0,
+  *       krtsze jest wycznie dla pozostaych przerwa.
+  *       Na stosie kadego zadania (rwnie IDLE) mieci si dodatkowo ramka
+  *       przerwania od SPI wraz z zagniedonym przerwaniem - dla wartoci 1
+  *       ustawionej w opcjach kompilatora (symbol projektu) FreeRTOSConfig.h
+  *       zwiksza configMINIMAL_STACK_SIZE; warto 1 zmieniona wycznie
+  *       w tym pliku przerywa kompilacj spi1wire.c.
+  */
+#ifndef SPI1WIRE_NESTED_ISR
+#define SPI1WIRE_NESTED_ISR			0
+#endif
+
+/**
+  * @def SPI1WIRE_NESTED_TIMSK, SPI1WIRE_NESTED_UCSRB
+  *
+  * Bity odblokowania przerwa rejestrw TIMSK i UCSRB blokowane na czas
+  * analizy szczeliny w trybie SPI1WIRE_NESTED_ISR = 1 - przerwania, ktrych
+  * programy obsugi mog przeczy kontekst systemu FreeRTOS: takt systemu
+  * (porwnanie Timer1, OCIE1A) oraz odbiornik USART (usart1wire.h, RXCIE).
+  * Stan bitw jest przywracany przy wyjciu z programu obsugi przerwania.
+  * Bez systemu operacyjnego domylnie nie jest blokowane adne przerwanie.
+  */
+#ifndef SPI1WIRE_NESTED_TIMSK
+#if SPI1WIRE_USE_FREERTOS
+#define SPI1WIRE_NESTED_TIMSK		(1 << OCIE1A)
+#else
+#define SPI1WIRE_NESTED_TIMSK		0
+#endif
+#endif
+#ifndef SPI1WIRE_NESTED_UCSRB
+#if SPI1WIRE_USE_FREERTOS
+#define SPI1WIRE_NESTED_UCSRB		(1 << RXCIE)
+#else
+#define SPI1WIRE_NESTED_UCSRB		0
+#endif
+#endif
+
+/**
+  * @def SPI1WIRE_TRACE, SPI1WIRE_TRACE_SIZE
+  *
+  * Rejestracja zdarze programu obsugi przerwania od SPI (1 - tak, 0 - nie)
+  * w buforze cyklicznym o SPI1WIRE_TRACE_SIZE wpisach (potga 2, maks. 128;
+  * wpis zajmuje 7 bajtw RAM). Bufor odczytywany jest przez zadanie funkcj
+  * SPI1Wire_TraceRead, bez blokowania przerwa; przy penym buforze nowe
+  * wpisy s pomijane. Rejestracja wydua program obsugi przerwania
+  * o ok. 40 taktw zegara (po wpisie SPDR, nie opnia szczeliny).
+  */
+#ifndef SPI1WIRE_TRACE
+#define SPI1WIRE_TRACE				0
+#endif
+#ifndef SPI1WIRE_TRACE_SIZE
+#define SPI1WIRE_TRACE_SIZE			16
+#endif
+
+/**
+  * @def SPI1WIRE_CAPTURE
+  *
+  * Rejestracja surowych prbek szczelin (1 - tak, 0 - nie): bajt odebrany
+  * z SPDR to 8 prbek stanu magistrali w czasie szczeliny. Po wywoaniu
+  * SPI1Wire_CaptureStart prbki wszystkich szczelin kolejnych rozkazw
+  * (RESET, PULSE, zapis, odczyt) zapisywane s wraz z odczytan wartoci
+  * bitu do bufora wywoujcego, np. w celu analizy czasu narastania zbocza
+  * i doboru maski odczytu. Rejestracja wydua program obsugi przerwania
+  * o ok. 30 taktw zegara (po wpisie SPDR, nie opnia szczeliny).
+  */
+#ifndef SPI1WIRE_CAPTURE
+#define SPI1WIRE_CAPTURE			0
+#endif
+
+/**
+  * @def SPI1WIRE_PULLUP_PORT, SPI1WIRE_PULLUP_DDR, SPI1WIRE_PULLUP_PIN
+  *
+  * Wyprowadzenie sterujce silnym podciganiem magistrali 1-Wire (np. bramk
+  * tranzystora P-MOSFET czcego magistral bezporednio z zasilaniem),
+  * definiowane w pliku main.h projektu. Wymagane przy zasilaniu pasoytniczym
+  * ukadw SLAVE - np. DS18B20 w trakcie konwersji pobiera do 1,5mA, podciganie
+  * musi zosta zaczone w cigu 10us od ostatniego bitu rozkazu ConvertT.
+  * SPI1WIRE_PULLUP_ACTIVE_LOW okrela poziom aktywny wyprowadzenia:
+  * 1 - niski (P-MOSFET, domylnie), 0 - wysoki.
+  * Wyprowadzenie konfigurowane jest w SPI1Wire_Init.
+  */
+#ifndef SPI1WIRE_PULLUP_ACTIVE_LOW
+#define SPI1WIRE_PULLUP_ACTIVE_LOW	1
+#endif
+
+/**
+  * @def SPI1WIRE_STRONG_PULLUP_ON, SPI1WIRE_STRONG_PULLUP_OFF
+  *
+  * Zaczenie (wyczenie) silnego podcigania magistrali 1-Wire, wykonywane
+  * w programie obsugi przerwania ISR bezporednio po ostatnim bicie transakcji
+  * ze znacznikiem SPI1WIRE_TR_PULLUP oraz przed rozpoczciem kolejnej.
+  * Domylnie sterowane jest wyprowadzenie SPI1WIRE_PULLUP_PIN, w przypadku jego
+  * braku makra s puste. Makra mog zosta zdefiniowane przez uytkownika.
+  */
+#ifndef SPI1WIRE_STRONG_PULLUP_ON
+#if defined(SPI1WIRE_PULLUP_PIN) && SPI1WIRE_PULLUP_ACTIVE_LOW
+#define SPI1WIRE_STRONG_PULLUP_ON()		do { SPI1WIRE_PULLUP_PORT &= ~(1 << SPI1WIRE_PULLUP_PIN); } while (0)
+#define SPI1WIRE_STRONG_PULLUP_OFF()	do { SPI1WIRE_PULLUP_PORT |= (1 << SPI1WIRE_PULLUP_PIN); } while (0)
+#elif defined(SPI1WIRE_PULLUP_PIN)
+#define SPI1WIRE_STRONG_PULLUP_ON()		do { SPI1WIRE_PULLUP_PORT |= (1 << SPI1WIRE_PULLUP_PIN); } while (0)
+#define SPI1WIRE_STRONG_PULLUP_OFF()	do { SPI1WIRE_PULLUP_PORT &= ~(1 << SPI1WIRE_PULLUP_PIN); } while (0)
+#else
+#define SPI1WIRE_STRONG_PULLUP_ON()		do { } while (0)
+#define SPI1WIRE_STRONG_PULLUP_OFF()	do { } while (0)
+#endif
+#endif
+
+/**
   * @def definicje wyprowadzen interfejsu SPI mikrokontrolera
   *
   * @note Interfejs w ukadzie MASTER jest aktywny tylko wwczas, gdy 
@@ -30,14 +180,50 @@
   * @def definicje rozkazw (oraz masek) interfejsu 1-Wire
   *
   * Kodowanie rozkazu (wartoci bitw)
-  * |R|C|C|-|L|L|L|L|
+  * |R|C|C|T|L|L|L|L|
   * R    - znacznik zakoczenia wykonywania rozkazu (Ready)
   * CC   - typ rozkazu: 00 - reset-pulse
   *                     01 - odczyt bajtu
   *                     10 - zapis bajtu
-  * LLLL - odliczanie przesyanych bitw  
+  *                     11 - krok przeszukiwania ROM (triplet),
+  *                          z T = 1 - koniec rozkazu (brak kolejnych szczelin)
+  * T    - dla zapisu: jednoczesny odczyt stanu magistrali w kadym
+  *        wysyanym bicie (tryb full-duplex, touch),
+  *        dla reset-pulse: sekwencja o czasach trybu overdrive
+  * LLLL - odliczanie przesyanych bitw (szczelin sekwencji RESET)
+  *
+  * Rozkazy odczytu i zapisu operuj na buforze bajtw, kolejne bajty s
+  * pobierane (zapisywane) w programie obsugi przerwania ISR, zakoczenie
+  * sygnalizowane jest jednokrotnie, po przesaniu ostatniego bajtu.
+  * Rozkaz opisuje kolejn wyznaczan szczelin, ktra wyprzedza szczelin
+  * przesyan o jedn pozycj (potokowe wyznaczanie wzorcw w spi1wire.c).
   */
 #define SPI1WIRE_NO_PRESENCE		0		/**< oznacza brak odpowiedzi ukadu SLAVE */
+
+/**
+  * @def kody bdw ostatniego rozkazu (SPI1Wire_GetError)
+  */
+#define SPI1WIRE_ERR_NONE			0		/**< rozkaz zakoczony poprawnie */
+#define SPI1WIRE_ERR_TIMEOUT		1		/**< rozkaz nie zakoczy si w wyznaczonym czasie
+                                                 (np. utracone przerwanie od SPI) */
+#define SPI1WIRE_ERR_STATE			2		/**< nieprawidowy stan automatu w programie
+                                                 obsugi przerwania ISR */
+#define SPI1WIRE_ERR_MODE			3		/**< konfiguracja SPI zmieniona poza bibliotek
+                                                 (wyzerowany bit SPE lub MSTR, np. stan
+                                                 niski na wejciu SS) */
+#define SPI1WIRE_ERR_ABORTED		4		/**< rozkaz przerwany przez SPI1Wire_Abort */
+
+/**
+  * @def SPI1WIRE_TIMEOUT_MARGIN_MS
+  *
+  * Zapas czasu oczekiwania na zakoczenie rozkazu [ms], dodawany do czasu
+  * wszystkich jego szczelin (np. przerwy wynikajce z obsugi innych przerwa).
+  * Po jego upywie interfejs SPI jest wyciszany, a funkcja zwraca bd
+  * SPI1WIRE_ERR_TIMEOUT - uszkodzenie kosztuje ograniczony, znany czas.
+  */
+#ifndef SPI1WIRE_TIMEOUT_MARGIN_MS
+#define SPI1WIRE_TIMEOUT_MARGIN_MS	10
+#endif
 
 #define SPI1WIRE_CMD_READY			0x80	/**< znacznik wskazujcy na zakoczenie 
                                                  generowania sekwencji interfejsu 1-Wire */
@@ -48,12 +234,148 @@
                                                  nie wykorzystywana */
 
 #define SPI1WIRE_CMD_RESETPULSE		0x00	/**< kod rozkazu RESET-PULSE-PRESENCE */
+#define SPI1WIRE_CMD_RESETPULSE_OD	0x10	/**< kod rozkazu RESET-PULSE-PRESENCE
+                                                 w trybie overdrive */
 #define SPI1WIRE_CMD_READ			0x20	/**< kod rozkazu odczytujcego bajt
                                                  z magistrali 1-Wire */
 #define SPI1WIRE_CMD_WRITE			0x40	/**< kod rozkazu wysyajcego bajt
                                                  na magistral 1-Wire */
+#define SPI1WIRE_CMD_TOUCH			0x50	/**< kod rozkazu wysyajcego bajt
+                                                 z jednoczesnym odczytem magistrali */
 
-#define SPI1WIRE_CMD_CNT_MASK		0x1F	/**< maska pozwalajca wyodrbni bity LLLL */
+#define SPI1WIRE_CMD_TRIPLET		0x60	/**< kod rozkazu: odczyt bitu, odczyt dopenienia
+                                                 i zapis wybranego kierunku przeszukiwania */
+#define SPI1WIRE_CMD_END			0x70	/**< wszystkie szczeliny rozkazu zostay wyznaczone */
+
+#define SPI1WIRE_CMD_CNT_MASK		0x0F	/**< maska pozwalajca wyodrbni bity LLLL */
+
+/**
+  * @def wynik rozkazu SPI1WIRE_CMD_TRIPLET (wartoci bitw)
+  */
+#define SPI1WIRE_TRIPLET_ID			0x01	/**< odczytany bit identyfikatora */
+#define SPI1WIRE_TRIPLET_CMP		0x02	/**< odczytane dopenienie bitu identyfikatora */
+#define SPI1WIRE_TRIPLET_DIR		0x04	/**< wysany (wybrany) kierunek przeszukiwania */
+
+/**
+  * @def prdko transmisji na magistrali 1-Wire
+  *
+  * Jeden bajt interfejsu SPI odpowiada jednej szczelinie czasowej 1-Wire,
+  * dzielniki wyznaczane s dla F_CPU w pliku spi1wire_timing.h; dla 14,7456MHz:
+  * - standard  - dzielnik 128, bit 8,68us, szczelina 69,4us,
+  * - overdrive - dzielnik 16, bit 1,09us, szczelina 8,68us; odczyt prbkowany
+  *               w drugim bicie (1,6us od pocztku szczeliny).
+  */
+#define SPI1WIRE_SPEED_STANDARD		0		/**< prdko standardowa */
+#define SPI1WIRE_SPEED_OVERDRIVE	1		/**< prdko overdrive */
+
+/**
+  * @def SPI1WIRE_OVERDRIVE
+  *
+  * Obsuga prdkoci overdrive (1 - tak, 0 - nie). Przy czstotliwociach F_CPU,
+  * dla ktrych interfejs SPI nie pozwala speni wymaga czasowych overdrive
+  * (np. 11,0592MHz), kompilacja przerywana jest bdem - naley wwczas
+  * wyczy obsug.
+  */
+#ifndef SPI1WIRE_OVERDRIVE
+#define SPI1WIRE_OVERDRIVE			1
+#endif
+
+/**
+  * @def SPI1WIRE_FAST_PROFILE
+  *
+  * Profil czasowy sekwencji RESET (spi1wire_timing.h):
+  * - 0 - impuls RESET z zapasem (500us, dla 14,7456MHz 8 bajtw - 555us),
+  * - 1 - impuls RESET rwny tRSTL min (480us, dla 14,7456MHz 7 bajtw - 486us;
+  *       w trybie overdrive 48us).
+  * Dzielnik SPI (w tym z bitem SPI2X) w obu profilach wybierany jest jako
+  * najmniejszy, dla ktrego bajt spenia tSLOT min; jedna szczelina zajmuje
+  * 8 bitw SPI, czyli 2^k * 8 taktw zegara - dla 14,7456MHz dzielnik 64 daje
+  * szczelin 34,7us (poniej 60us), dlatego szczelina nie moe by krtsza
+  * ni 69,4us. Przepustowo dla 14,7456MHz (szczelina 69,4us oraz ok. 3us
+  * wejcia do programu obsugi przerwania):
+  * - bajt danych - ok. 580us (ok. 1720 bajtw/s) w obu profilach,
+  * - RESET-PULSE-PRESENCE - 833us (profil 0), 764us (profil 1),
+  * - RESET, SkipROM, ReadScratchpad, 9 bajtw - ok. 7,2ms (profil 0),
+  *   ok. 7,1ms (profil 1).
+  */
+#ifndef SPI1WIRE_FAST_PROFILE
+#define SPI1WIRE_FAST_PROFILE		0
+#endif
+
+/**
+  * @def SPI1WIRE_SEARCH_TRIPLET
+  *
+  * Sposb realizacji kroku przeszukiwania ROM w SPI1Wire_SearchFirst/Next:
+  * - 1 - jeden rozkaz SPI1WIRE_CMD_TRIPLET (trzy sekwencje w programie obsugi
+  *       przerwania, jedno wybudzenie zadania),
+  * - 0 - trzy niezalene wywoania SPI1Wire_ReadBit/SPI1Wire_WriteBit
+  *       (wersja odniesienia, do porwnania czasu przeszukiwania).
+  */
+#ifndef SPI1WIRE_SEARCH_TRIPLET
+#define SPI1WIRE_SEARCH_TRIPLET		1
+#endif
+
+/**
+  * @def rozkazy warstwy ROM wykorzystywane przez bibliotek
+  */
+#define SPI1WIRE_ROM_SEARCH			0xF0	/**< Search ROM */
+#define SPI1WIRE_ROM_OVERDRIVE_SKIP	0x3C	/**< Overdrive Skip ROM */
+#define SPI1WIRE_ROM_OVERDRIVE_MATCH	0x69	/**< Overdrive Match ROM */
+#define SPI1WIRE_ROM_MATCH			0x55	/**< Match ROM */
+#define SPI1WIRE_ROM_RESUME			0xA5	/**< Resume */
+
+#define SPI1WIRE_ROM_SIZE			8		/**< dugo identyfikatora ROM w bajtach */
+
+/**
+  * @def SPI1WIRE_RESUME_FAMILY
+  *
+  * Rodziny ukadw obsugujcych rozkaz Resume (kod rodziny - pierwszy bajt
+  * identyfikatora): DS2431 (0x2D), DS28EA00 (0x42). Ukad wybrany rozkazem
+  * Match ROM ustawia znacznik RC, kasowany przez kady inny rozkaz warstwy ROM;
+  * do chwili skasowania znacznika ukad moe by wybierany jednym bajtem 0xA5
+  * zamiast dziewiciu (SPI1Wire_Execute). Makro z parametrem (kod rodziny),
+  * zwracajce warto rn od zera dla rodzin obsugujcych Resume;
+  * zastpowanie rozkazu Match ROM wycza definicja w opcjach kompilatora:
+  * SPI1WIRE_RESUME_FAMILY(family)=0 (w pliku: #define SPI1WIRE_RESUME_FAMILY(family) 0).
+  */
+#ifndef SPI1WIRE_RESUME_FAMILY
+#define SPI1WIRE_RESUME_FAMILY(family)	(((family) == 0x2D) || ((family) == 0x42))
+#endif
+
+/**
+  * Stan przeszukiwania magistrali (algorytm Search ROM)
+  */
+typedef struct
+{
+	uint8_t rom[SPI1WIRE_ROM_SIZE];	/**< identyfikator ostatnio znalezionego ukadu */
+	uint8_t last_discrepancy;		/**< numer bitu (1-64) ostatniej niejednoznacznoci */
+	uint8_t last_device;			/**< znacznik znalezienia ostatniego ukadu */
+} SPI1Wire_Search;
+
+/**
+  * @def znaczniki transakcji interfejsu 1-Wire (pole flags SPI1Wire_Transaction)
+  */
+#define SPI1WIRE_TR_RESET			0x01	/**< transakcja rozpoczyna si sekwencj
+                                                 RESET-PULSE-PRESENCE */
+#define SPI1WIRE_TR_PULLUP			0x02	/**< po ostatnim bicie zaczane jest silne
+                                                 podciganie magistrali */
+
+/**
+  * Opis transakcji interfejsu 1-Wire
+  *
+  * Transakcja skada si z (opcjonalnych) faz wykonywanych kolejno, w caoci
+  * w programie obsugi przerwania ISR: RESET-PULSE-PRESENCE, zapis bloku,
+  * odczyt bloku, podtrzymanie magistrali. Brak odpowiedzi ukadw SLAVE na
+  * sekwencj RESET koczy transakcj.
+  */
+typedef struct
+{
+	uint8_t flags;				/**< znaczniki SPI1WIRE_TR_xxx */
+	const uint8_t *write;		/**< dane wysyane po sekwencji RESET */
+	uint16_t write_length;		/**< liczba wysyanych bajtw (0 - brak fazy zapisu) */
+	uint8_t *read;				/**< bufor na dane odczytane po fazie zapisu */
+	uint16_t read_length;		/**< liczba odczytywanych bajtw (0 - brak fazy odczytu) */
+} SPI1Wire_Transaction;
 
 /**
   * Funkcja inicjalizujca interfejs SPI mikrokontrolera
@@ -61,6 +383,9 @@
   * Wybierany jest tryb pracy interfejsu SPI, tak by moliwe byo generowanie
   * poprawnych sekwencji (przebiegw czasowych) dla interfejsu 1-Wire.
   * Dodatkowo wymagane jest odblokowanie przerwa.
+  * W trybie SPI1WIRE_USE_FREERTOS tworzony jest semafor sygnalizujcy
+  * zakoczenie sekwencji, dlatego funkcj naley wywoa przed
+  * uruchomieniem planisty.
   *
   * @param  brak
   * @return brak
@@ -68,12 +393,118 @@
   */
 void SPI1Wire_Init(void);
 
+/**
+  * Funkcja wybierajca prdko transmisji na magistrali 1-Wire
+  *
+  * Zmieniany jest dzielnik sygnau zegarowego interfejsu SPI (rejestry SPCR
+  * i SPSR) oraz sposb prbkowania szczelin odczytu; przy SPI1WIRE_OVERDRIVE
+  * rwnym 0 zawsze wybierana jest prdko standardowa. Funkcj naley wywoywa
+  * wycznie pomidzy transakcjami. Zmiana prdkoci ukadw SLAVE wymaga
+  * rozkazu SPI1WIRE_ROM_OVERDRIVE_xxx (SPI1Wire_OverdriveSkip/Match).
+  *
+  * @param  speed SPI1WIRE_SPEED_STANDARD lub SPI1WIRE_SPEED_OVERDRIVE
+  * @return brak
+  *
+  */
+void SPI1Wire_SetSpeed(uint8_t speed);
+
+/**
+  * Funkcja zwracajca biec prdko transmisji na magistrali 1-Wire
+  *
+  * @param  brak
+  * @return SPI1WIRE_SPEED_STANDARD lub SPI1WIRE_SPEED_OVERDRIVE
+  *
+  */
+uint8_t SPI1Wire_GetSpeed(void);
+
+/**< minimalna liczba szczelin 0 i 1 wymagana do wyznaczenia maski odczytu */
+#define SPI1WIRE_CALIBRATE_MIN		8
+
+/**
+  * Funkcja wyznaczajca mask prbkowania szczelin odczytu dla biecej prdkoci
+  *
+  * Domylna maska (spi1wire_timing.h) zakada czas narastania zbocza do 5us;
+  * na dugich lub silnie obcionych magistralach stan wysoki w szczelinie 1
+  * pojawia si pniej i bity odczytywane s bdnie. Funkcja wykonuje rozkaz
+  * Search ROM, zapisujc prbki (bajt SPDR) obu szczelin odczytu kadego bitu
+  * identyfikatora - jedna z nich jest szczelin 0, druga szczelin 1, o ile
+  * wszystkie ukady s zgodne. Wybierane s bity bajtu SPI o stanie wysokim we
+  * wszystkich szczelinach 1 i niskim we wszystkich szczelinach 0. Wynik
+  * zapamitywany jest dla biecej prdkoci i przywracany przez
+  * SPI1Wire_SetSpeed. Wzorzec szczeliny zapisu 1 i odczytu nie jest zmieniany
+  * (przy prdkoci standardowej impuls trwa jeden bit SPI, tLOW1 max to 15us).
+  * Wymagany jest co najmniej jeden ukad SLAVE.
+  *
+  * @param  brak
+  * @return wyznaczona maska, 0 - brak ukadw lub zbyt maa liczba szczelin
+  *         (maska nie jest zmieniana)
+  *
+  */
+uint8_t SPI1Wire_Calibrate(void);
+
+/**
+  * Funkcja ustawiajca mask prbkowania szczelin odczytu dla biecej prdkoci
+  *
+  * Pozwala przywrci mask wyznaczon wczeniej przez SPI1Wire_Calibrate
+  * (np. zapisan w pamici EEPROM) bez ponownej kalibracji.
+  *
+  * @param  mask bity SPDR, ktre w szczelinie odczytu o wartoci 1 musz mie
+  *         stan wysoki; 0 - maska domylna
+  * @return brak
+  *
+  */
+void SPI1Wire_SetReadMask(uint8_t mask);
+
+/**
+  * Funkcja zwracajca mask prbkowania szczelin odczytu dla biecej prdkoci
+  *
+  * @param  brak
+  * @return bieca maska
+  *
+  */
+uint8_t SPI1Wire_GetReadMask(void);
+
+#if SPI1WIRE_OVERDRIVE
+/**
+  * Funkcja przeczajca wszystkie ukady SLAVE obsugujce tryb overdrive
+  * w ten tryb (Overdrive Skip ROM)
+  *
+  * Sekwencja RESET i rozkaz 0x3C wysyane s z prdkoci standardow, nastpnie
+  * interfejs przeczany jest na prdko overdrive. Po rozkazie ukady oczekuj
+  * na funkcj (jak po Skip ROM), kolejne sekwencje RESET generowane s w trybie
+  * overdrive.
+  *
+  * @param  brak
+  * @return wynik sekwencji PRESENCE (jak SPI1Wire_ResetPresence), w przypadku
+  *         braku odpowiedzi prdko pozostaje standardowa
+  *
+  */
+uint8_t SPI1Wire_OverdriveSkip(void);
+
+/**
+  * Funkcja wybierajca ukad SLAVE z jednoczesnym przeczeniem w tryb
+  * overdrive (Overdrive Match ROM)
+  *
+  * Sekwencja RESET i rozkaz 0x69 wysyane s z prdkoci standardow,
+  * identyfikator ROM z prdkoci overdrive.
+  *
+  * @param  [in] rom identyfikator wybieranego ukadu (SPI1WIRE_ROM_SIZE bajtw)
+  * @return wynik sekwencji PRESENCE (jak SPI1Wire_ResetPresence), w przypadku
+  *         braku odpowiedzi prdko pozostaje standardowa
+  *
+  */
+uint8_t SPI1Wire_OverdriveMatch(const uint8_t *rom);
+#endif
+
 /**
   * Funkcja generujca sekwencj RESET-PULSE-PRESENCE protokou 1-Wire
   *
   * Wybierany jest tryb pracy interfejsu SPI, tak by moliwe byo generowanie
   * poprawnych sekwencji (przebiegw czasowych) dla interfejsu 1-Wire.
   * Wymagana jest wczeniejsze zainicjowanie interfejsu SPI.
+  * Przy prdkoci overdrive brak odpowiedzi powoduje powrt do prdkoci
+  * standardowej i powtrzenie sekwencji (standardowy RESET przywraca
+  * prdko standardow rwnie w ukadach SLAVE).
   *
   * @param  brak
   * @return zwracana jest warto rwna 0, jeeli do magistrali nie zosta
@@ -83,6 +514,65 @@ void SPI1Wire_Init(void);
   */
 uint8_t SPI1Wire_ResetPresence(void);
 
+/**
+  * @def wynik diagnostycznej sekwencji RESET (SPI1Wire_ResetDiagnostic)
+  *
+  * Wartoci mniejsze od SPI1WIRE_DIAG_NO_PRESENCE oznaczaj odpowied ukadw
+  * SLAVE - magistrala moe by wykorzystana do transmisji.
+  */
+#define SPI1WIRE_DIAG_OK			0		/**< impuls PRESENCE zgodny z wymaganiami */
+#define SPI1WIRE_DIAG_TIMING		1		/**< impuls PRESENCE poza wymaganiami czasowymi
+                                                 (tPDH, tPDL), ukady odpowiadaj */
+#define SPI1WIRE_DIAG_NO_PRESENCE	2		/**< brak impulsu PRESENCE */
+#define SPI1WIRE_DIAG_SHORT			3		/**< stan niski przed sekwencj RESET (zwarcie
+                                                 magistrali do masy), RESET nie jest wysyany */
+#define SPI1WIRE_DIAG_STUCK_LOW		4		/**< magistrala nie powrcia do stanu wysokiego
+                                                 przed kocem obserwacji (tRSTH) */
+#define SPI1WIRE_DIAG_FAULT			5		/**< bd sterownika (SPI1Wire_GetError) */
+
+#define SPI1WIRE_DIAG_SAMPLES		8		/**< maksymalna liczba bajtw obserwacji magistrali */
+#define SPI1WIRE_DIAG_NONE			0xFF	/**< brak impulsu PRESENCE (pole presence_start) */
+
+/**
+  * Wynik diagnostycznej sekwencji RESET-PULSE-PRESENCE
+  *
+  * Prbki zapisywane s w kolejnoci nadawania bitw SPI (od najstarszego),
+  * bit i prbkowany jest (i + 0,5) * bit_ns od zwolnienia magistrali; stan
+  * niski to bit o wartoci 0.
+  */
+typedef struct
+{
+	uint8_t idle;				/**< prbki magistrali przed sekwencj RESET (0xFF - stan wysoki) */
+	uint8_t samples[SPI1WIRE_DIAG_SAMPLES]; /**< prbki po zwolnieniu magistrali */
+	uint8_t length;				/**< liczba bajtw samples (0 - RESET nie by wysany) */
+	uint16_t bit_ns;			/**< czas bitu interfejsu SPI [ns] */
+	uint8_t presence_start;		/**< numer pierwszej prbki impulsu PRESENCE
+	                                 (SPI1WIRE_DIAG_NONE - brak impulsu) */
+	uint8_t presence_width;		/**< liczba kolejnych prbek impulsu PRESENCE */
+	uint8_t recovered;			/**< stan wysoki w ostatniej prbce obserwacji */
+} SPI1Wire_Diagnostic;
+
+/**
+  * Funkcja generujca diagnostyczn sekwencj RESET-PULSE-PRESENCE
+  *
+  * Przed sekwencj RESET obserwowany jest stan magistrali przez czas jednej
+  * szczeliny (bajt 0xFF, bez impulsu zapisu); stan niski we wszystkich
+  * prbkach oznacza zwarcie i sekwencja RESET nie jest wysyana. W trakcie
+  * obserwacji magistrali po sekwencji RESET zapisywane s wszystkie prbki,
+  * na ich podstawie wyznaczany jest pocztek i czas trwania impulsu PRESENCE
+  * z rozdzielczoci bitu SPI (8,68us, w trybie overdrive 1,09us dla
+  * 14,7456MHz) oraz powrt magistrali do stanu wysokiego.
+  * Sekwencja wykonywana jest z biec prdkoci, bez powrotu do prdkoci
+  * standardowej w przypadku braku odpowiedzi. Czas wykonania jest o jedn
+  * szczelin duszy ni SPI1Wire_ResetPresence, funkcja moe j zastpi
+  * przed kad transakcj.
+  *
+  * @param  [out] diag wynik obserwacji magistrali
+  * @return SPI1WIRE_DIAG_xxx
+  *
+  */
+uint8_t SPI1Wire_ResetDiagnostic(SPI1Wire_Diagnostic *diag);
+
 /**
   * Funkcja wysyajca bajt danych na magistral 1-Wire
   *
@@ -105,4 +595,292 @@ void SPI1Wire_Write(uint8_t byte);
   */
 uint8_t SPI1Wire_Read(void);
 
+/**
+  * Funkcja wykonujca transakcj interfejsu 1-Wire
+  *
+  * Zadanie wywoujce uczestniczy wycznie w rozpoczciu transakcji, przejcia
+  * pomidzy fazami (np. SkipROM + ReadScratchpad + odczyt 9 bajtw) realizowane
+  * s w programie obsugi przerwania ISR, bez opnie wynikajcych z szeregowania
+  * zada. Wymagana jest wczeniejsze zainicjowanie interfejsu SPI.
+  * Transakcja ze znacznikiem SPI1WIRE_TR_RESET, na ktr przy prdkoci
+  * overdrive nie odpowiedzia aden ukad, powtarzana jest z prdkoci
+  * standardow (jak SPI1Wire_ResetPresence).
+  * Pierwszy bajt zapisu po sekwencji RESET (w tej samej transakcji lub
+  * po SPI1Wire_ResetPresence) traktowany jest jako rozkaz warstwy ROM:
+  * Match ROM wraz z identyfikatorem (w jednym bloku) ukadu wybranego
+  * poprzednio, nalecego do rodziny SPI1WIRE_RESUME_FAMILY, wysyany jest
+  * jako rozkaz Resume; pozostae bajty bloku wysyane s bez zmian.
+  *
+  * @param  [in] transaction opis transakcji
+  * @return dla transakcji ze znacznikiem SPI1WIRE_TR_RESET wynik sekwencji
+  *         PRESENCE (jak SPI1Wire_ResetPresence), w przeciwnym razie warto
+  *         rna od zera; bd sterownika (SPI1Wire_GetError) zwraca
+  *         SPI1WIRE_NO_PRESENCE
+  *
+  */
+uint8_t SPI1Wire_Execute(const SPI1Wire_Transaction *transaction);
+
+/**
+  * Funkcja uniewaniajca zapamitany ukad wybrany rozkazem Match ROM
+  *
+  * Kolejny wybr ukadu wysyany jest penym rozkazem Match ROM. Naley j
+  * wywoa po bdzie transmisji (np. CRC) w transakcji z takim ukadem - ukad
+  * mg utraci zasilanie i znacznik RC, a rozkaz Resume nie wybiera wtedy
+  * adnego ukadu.
+  *
+  * @param  brak
+  * @return brak
+  *
+  */
+void SPI1Wire_ResumeClear(void);
+
+/**
+  * Funkcja zwracajca kod bdu ostatniego rozkazu
+  *
+  * Wszystkie funkcje generujce sekwencje na magistrali oczekuj na ich
+  * zakoczenie przez ograniczony czas; funkcje bez wartoci zwracanej
+  * (np. SPI1Wire_WriteBlock) sygnalizuj bd wycznie tym kodem,
+  * odczytane dane s wwczas niekompletne.
+  *
+  * @param  brak
+  * @return SPI1WIRE_ERR_xxx
+  *
+  */
+uint8_t SPI1Wire_GetError(void);
+
+/**
+  * Funkcja przerywajca rozkaz w trakcie wykonania
+  *
+  * Blokowane jest przerwanie od SPI, interfejs jest wyciszany (zakoczenie
+  * biecego bajtu, zwolnienie magistrali, przywrcenie konfiguracji SPCR),
+  * a automat sterownika wraca do stanu pocztkowego; zadanie oczekujce na
+  * zakoczenie rozkazu jest budzone z bdem SPI1WIRE_ERR_ABORTED. Przy braku
+  * rozkazu w trakcie wykonania funkcja nie wykonuje adnych czynnoci.
+  * Funkcja przeznaczona jest dla zadania innego ni oczekujce, nie moe by
+  * wywoywana z programu obsugi przerwania.
+  *
+  * @param  brak
+  * @return brak
+  *
+  */
+void SPI1Wire_Abort(void);
+
+/**
+  * Funkcja wysyajca blok danych na magistral 1-Wire
+  *
+  * Cay blok przesyany jest w programie obsugi przerwania ISR, bez udziau
+  * zadania wywoujcego pomidzy kolejnymi bajtami.
+  * Wymagana jest wczeniejsze zainicjowanie interfejsu SPI.
+  *
+  * @param  [in] buffer wysyane dane
+  * @param  length liczba wysyanych bajtw
+  * @return brak
+  *
+  */
+void SPI1Wire_WriteBlock(const uint8_t *buffer, uint16_t length);
+
+/**
+  * Funkcja pobierajca blok danych z magistrali 1-Wire
+  *
+  * Cay blok odczytywany jest w programie obsugi przerwania ISR, bez udziau
+  * zadania wywoujcego pomidzy kolejnymi bajtami.
+  * Wymagana jest wczeniejsze zainicjowanie interfejsu SPI.
+  *
+  * @param  [out] buffer bufor na odczytane dane
+  * @param  length liczba odczytywanych bajtw
+  * @return brak
+  *
+  */
+void SPI1Wire_ReadBlock(uint8_t *buffer, uint16_t length);
+
+/**
+  * Funkcja wymieniajca blok danych z magistral 1-Wire (full-duplex)
+  *
+  * Kady bit bufora jest wysyany, a w tej samej sekwencji odczytywany jest
+  * stan magistrali; wynik zastpuje wysane dane. Wysanie bitu o wartoci 1
+  * jest rwnowane sekwencji odczytu, bit o wartoci 0 zawsze odczytywany
+  * jest jako 0.
+  * Wymagana jest wczeniejsze zainicjowanie interfejsu SPI.
+  *
+  * @param  [in,out] buffer dane do wysania, po powrocie dane odczytane
+  * @param  length liczba przesyanych bajtw
+  * @return brak
+  *
+  */
+void SPI1Wire_TouchBlock(uint8_t *buffer, uint16_t length);
+
+/**
+  * Funkcja wysyajca pojedynczy bit na magistral 1-Wire
+  *
+  * Wymagana jest wczeniejsze zainicjowanie interfejsu SPI.
+  *
+  * @param  bit wysyana warto (0 lub rna od zera)
+  * @return brak
+  *
+  */
+void SPI1Wire_WriteBit(uint8_t bit);
+
+/**
+  * Funkcja pobierajca pojedynczy bit z magistrali 1-Wire
+  *
+  * Wymagana jest wczeniejsze zainicjowanie interfejsu SPI.
+  *
+  * @param  brak
+  * @return odczytany bit (0 lub 1)
+  *
+  */
+uint8_t SPI1Wire_ReadBit(void);
+
+/**
+  * Funkcja wykonujca krok przeszukiwania ROM (triplet)
+  *
+  * W jednym rozkazie, w programie obsugi przerwania ISR, odczytywany jest bit
+  * identyfikatora oraz jego dopenienie, a nastpnie wysyany jest kierunek
+  * przeszukiwania: zgodny z bitem identyfikatora, gdy wszystkie ukady s zgodne,
+  * lub direction w przypadku niejednoznacznoci. Gdy oba odczytane bity maj
+  * warto 1 (brak ukadw) kierunek nie jest wysyany.
+  *
+  * @param  direction kierunek wybierany w przypadku niejednoznacznoci (0 lub 1)
+  * @return kombinacja SPI1WIRE_TRIPLET_ID, SPI1WIRE_TRIPLET_CMP, SPI1WIRE_TRIPLET_DIR
+  *
+  */
+uint8_t SPI1Wire_Triplet(uint8_t direction);
+
+/**
+  * Funkcja rozpoczynajca przeszukiwanie magistrali (Search ROM)
+  *
+  * @param  [out] search stan przeszukiwania, w polu rom identyfikator
+  *         pierwszego ukadu
+  * @return 0 - brak ukadw lub bd CRC, w przeciwnym razie warto rna od zera
+  *
+  */
+uint8_t SPI1Wire_SearchFirst(SPI1Wire_Search *search);
+
+/**
+  * Funkcja wyszukujca kolejny ukad na magistrali (Search ROM)
+  *
+  * @param  [in,out] search stan przeszukiwania z poprzedniego wywoania
+  *         SPI1Wire_SearchFirst/SPI1Wire_SearchNext
+  * @return 0 - brak kolejnych ukadw lub bd, w przeciwnym razie warto
+  *         rna od zera
+  *
+  */
+uint8_t SPI1Wire_SearchNext(SPI1Wire_Search *search);
+
+/**
+  * @def SPI1Wire_CRC8(buffer, length)
+  *
+  * Suma kontrolna CRC8 (Dallas/Maxim) bloku danych - funkcja OneWire_CRC8
+  * wsplna dla wszystkich bibliotek 1-Wire (onewire_crc.h)
+  */
+#define SPI1Wire_CRC8(buffer, length)	OneWire_CRC8(buffer, length)
+
+/**
+  * Funkcja zwracajca sum kontroln CRC8 danych odczytanych w ostatnim rozkazie
+  *
+  * Suma wyznaczana jest w programie obsugi przerwania ISR, bit po bicie, dla
+  * wszystkich bitw odczytanych od pocztku ostatniego rozkazu (faza odczytu
+  * transakcji, SPI1Wire_ReadBlock, SPI1Wire_TouchBlock). Odczyt bloku zakoczonego
+  * sum kontroln (np. 9 bajtw pamici scratchpad, identyfikator ROM) nie wymaga
+  * ponownego przetwarzania bufora przez SPI1Wire_CRC8.
+  *
+  * @note Dla transakcji bez fazy odczytu (np. brak impulsu PRESENCE) zwracane
+  *       jest 0 - wynik naley sprawdza wycznie po wykonaniu odczytu.
+  *
+  * @param  brak
+  * @return suma kontrolna; dla danych zakoczonych poprawn sum wynosi 0
+  *
+  */
+uint8_t SPI1Wire_GetCRC8(void);
+
+#if SPI1WIRE_TRACE
+/**
+  * Wpis bufora zdarze programu obsugi przerwania od SPI
+  *
+  * Znacznik czasu to stan licznika Timer1 (takt systemu FreeRTOS, preskaler 64,
+  * zerowany co 1ms - 4,34us dla 14,7456MHz) tu po wpisie SPDR oraz modszy bajt
+  * licznika taktw systemu; rnica znacznikw kolejnych wpisw pomniejszona
+  * o czas szczeliny to przerwa pomidzy szczelinami. W wersji bez systemu
+  * operacyjnego licznik Timer1 musi zosta uruchomiony przez aplikacj,
+  * pole tick jest rwne 0.
+  */
+typedef struct
+{
+	uint16_t time;		/**< stan TCNT1 przy wejciu do programu obsugi przerwania */
+	uint8_t tick;		/**< modszy bajt licznika taktw systemu */
+	uint8_t action;		/**< czynno zakoczonej szczeliny (kod ACT, bit 7 - rozpoczto
+	                         kolejn szczelin) */
+	uint8_t out;		/**< wzorzec wpisany do SPDR (wany przy ustawionym bicie 7 action) */
+	uint8_t in;			/**< bajt odebrany z SPDR (prbki zakoczonej szczeliny) */
+	uint8_t result;		/**< wynik: licznik PRESENCE lub odczytywany bajt (bit odczytany
+	                         w szczelinie na najstarszej pozycji) / znaczniki TRIPLET */
+} SPI1Wire_TraceEntry;
+
+/**
+  * Funkcja pobierajca najstarszy wpis z bufora zdarze
+  *
+  * Funkcja moe by wywoywana wycznie przez jedno zadanie.
+  *
+  * @param  [out] entry pobrany wpis
+  * @return 0 - bufor pusty, w przeciwnym razie warto rna od zera
+  *
+  */
+uint8_t SPI1Wire_TraceRead(SPI1Wire_TraceEntry *entry);
+
+/**
+  * Funkcja zwracajca i zerujca liczb wpisw pominitych przy penym buforze
+  *
+  * @param  brak
+  * @return liczba pominitych wpisw (maks. 255)
+  *
+  */
+uint8_t SPI1Wire_TraceDropped(void);
+#endif
+
+#if SPI1WIRE_CAPTURE
+/**
+  * Prbki pojedynczej szczeliny (SPI1Wire_CaptureStart)
+  *
+  * Kolejne bity pola raw to stan magistrali w kolejnych bitach SPI (najstarszy
+  * bit - pocztek szczeliny, dla 14,7456MHz co 8,68us, w trybie overdrive
+  * co 1,09us). Pole bit zawiera warto wyznaczon przez bibliotek: dla
+  * szczelin odczytu (rwnie TRIPLET i TOUCH) odczytany bit wedug biecej
+  * maski odczytu, dla bajtu identyfikacji impulsu PRESENCE 0 - impuls wykryty,
+  * 1 - brak impulsu; dla pozostaych szczelin (RESET, PULSE, zapis)
+  * SPI1WIRE_CAPTURE_NO_BIT.
+  */
+typedef struct
+{
+	uint8_t raw;		/**< bajt odebrany z SPDR */
+	uint8_t bit;		/**< warto odczytana w szczelinie */
+} SPI1Wire_SlotCapture;
+
+#define SPI1WIRE_CAPTURE_NO_BIT		0xFF	/**< szczelina bez analizy odpowiedzi */
+
+/**
+  * Funkcja rozpoczynajca rejestracj prbek szczelin
+  *
+  * Prbki wszystkich szczelin kolejnych rozkazw zapisywane s do bufora
+  * w kolejnoci szczelin; po zapenieniu bufora rejestracja jest wstrzymywana
+  * (rozkazy wykonywane s bez zmian). Funkcj naley wywoywa pomidzy
+  * rozkazami.
+  *
+  * @param  [out] buffer bufor na prbki szczelin
+  * @param  size liczba wpisw bufora
+  * @return brak
+  *
+  */
+void SPI1Wire_CaptureStart(SPI1Wire_SlotCapture *buffer, uint16_t size);
+
+/**
+  * Funkcja koczca rejestracj prbek szczelin
+  *
+  * @param  brak
+  * @return liczba zapisanych wpisw (rwna rozmiarowi bufora - bufor zapeniony,
+  *         cz szczelin moga zosta pominita)
+  *
+  */
+uint16_t SPI1Wire_CaptureStop(void);
+#endif
+
 #endif //SPI1WIRE_H_
\ No newline at end of file
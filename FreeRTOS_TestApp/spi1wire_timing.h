@@ -0,0 +1,245 @@
+/** @file spi1wire_timing.h
+  *
+  * @author B.W.
+  *
+  * Parametry sekwencji interfejsu 1-Wire generowanych przez interfejs SPI,
+  * wyznaczane w czasie kompilacji na podstawie czstotliwoci F_CPU:
+  * dzielnik sygnau zegarowego SPI, wzorce bajtw szczelin czasowych, liczba
+  * bajtw sekwencji RESET-PULSE-PRESENCE oraz maski prbkowania odczytu.
+  * Jeden bajt interfejsu SPI odpowiada jednej szczelinie czasowej 1-Wire,
+  * dla kadej prdkoci wybierany jest najmniejszy dzielnik, przy ktrym
+  * szczelina spenia wymagania; brak takiego dzielnika przerywa kompilacj.
+  *
+  */
+
+#ifndef SPI1WIRE_TIMING_H_
+#define SPI1WIRE_TIMING_H_
+
+#include "main.h"
+#include "spi1wire.h"
+
+#ifndef F_CPU
+#error "F_CPU nie zostala zdefiniowana"
+#endif
+
+/**
+  * @def wymagania czasowe interfejsu 1-Wire [ns], prdko standardowa
+  */
+#define SPI1WIRE_STD_SLOT_MIN_NS		60000UL		/**< tSLOT, tLOW0 min (bajt 0x00) */
+#define SPI1WIRE_STD_SLOT_MAX_NS		120000UL	/**< tSLOT, tLOW0 max */
+#define SPI1WIRE_STD_LOW1_MIN_NS		1000UL		/**< tLOW1, tRL min */
+#define SPI1WIRE_STD_LOW1_MAX_NS		15000UL		/**< tLOW1 max */
+#define SPI1WIRE_STD_RISE_NS			5000UL		/**< pominicie prbek tu po zwolnieniu
+                                                         magistrali (narastanie zbocza) */
+#define SPI1WIRE_STD_SAMPLE_MAX_NS		SPI1WIRE_STD_SLOT_MAX_NS /**< ostatnia prbka odczytu */
+#if SPI1WIRE_FAST_PROFILE
+#define SPI1WIRE_STD_RESET_NS			480000UL	/**< tRSTL min */
+#else
+#define SPI1WIRE_STD_RESET_NS			500000UL	/**< tRSTL (min 480us) z zapasem */
+#endif
+#define SPI1WIRE_STD_RESET_MAX_NS		960000UL	/**< tRSTL max */
+#define SPI1WIRE_STD_RSTH_NS			240000UL	/**< obserwacja magistrali po RESET (tPDL max) */
+#define SPI1WIRE_STD_PDH_MIN_NS			15000UL		/**< tPDH min */
+#define SPI1WIRE_STD_PDH_MAX_NS			60000UL		/**< tPDH max */
+#define SPI1WIRE_STD_PDL_MIN_NS			60000UL		/**< tPDL min */
+
+/**
+  * @def wymagania czasowe interfejsu 1-Wire [ns], prdko overdrive
+  */
+#define SPI1WIRE_OD_SLOT_MIN_NS			6000UL
+#define SPI1WIRE_OD_SLOT_MAX_NS			16000UL
+#define SPI1WIRE_OD_LOW1_MIN_NS			1000UL
+#define SPI1WIRE_OD_LOW1_MAX_NS			2000UL
+#define SPI1WIRE_OD_RISE_NS				500UL
+#define SPI1WIRE_OD_SAMPLE_MAX_NS		2000UL		/**< tMSR max */
+#if SPI1WIRE_FAST_PROFILE
+#define SPI1WIRE_OD_RESET_NS			48000UL		/**< tRSTL min */
+#else
+#define SPI1WIRE_OD_RESET_NS			50000UL		/**< tRSTL (min 48us) z zapasem */
+#endif
+#define SPI1WIRE_OD_RESET_MAX_NS		80000UL		/**< tRSTL max */
+#define SPI1WIRE_OD_RSTH_NS				48000UL		/**< tRSTH min */
+#define SPI1WIRE_OD_PDH_MIN_NS			2000UL
+#define SPI1WIRE_OD_PDH_MAX_NS			6000UL
+#define SPI1WIRE_OD_PDL_MIN_NS			8000UL
+
+/**< maksymalna liczba bajtw sekwencji RESET-PULSE-PRESENCE (pole LLLL rozkazu) */
+#define SPI1WIRE_RESET_BYTES_MAX		16
+
+/**
+  * @def SPI1WIRE_BIT_NS(div)
+  *
+  * Czas przesania bitu interfejsu SPI [ns] dla dzielnika div.
+  */
+#define SPI1WIRE_BIT_NS(div)			((div) * 1000000UL / (F_CPU / 1000UL))
+
+/**
+  * @def SPI1WIRE_SAMPLE_MASK(tb, from, to)
+  *
+  * Maska bitw bajtu SPI (wysyanych od najstarszego), ktrych prbka,
+  * w chwili (i + 0,5) * tb od pocztku bajtu, przypada w przedziale <from, to>.
+  */
+#define SPI1WIRE_SAMPLE(i, tb, from, to)	\
+	((((2 * (i) + 1) * (tb) / 2) >= (from)) && (((2 * (i) + 1) * (tb) / 2) <= (to)) ? (0x80 >> (i)) : 0)
+#define SPI1WIRE_SAMPLE_MASK(tb, from, to)	\
+	(SPI1WIRE_SAMPLE(0, tb, from, to) | SPI1WIRE_SAMPLE(1, tb, from, to) |	\
+	 SPI1WIRE_SAMPLE(2, tb, from, to) | SPI1WIRE_SAMPLE(3, tb, from, to) |	\
+	 SPI1WIRE_SAMPLE(4, tb, from, to) | SPI1WIRE_SAMPLE(5, tb, from, to) |	\
+	 SPI1WIRE_SAMPLE(6, tb, from, to) | SPI1WIRE_SAMPLE(7, tb, from, to))
+
+/**
+  * @def SPI1WIRE_SPCR_DIV(div), SPI1WIRE_SPSR_DIV(div)
+  *
+  * Bity SPR1:SPR0 rejestru SPCR oraz SPI2X rejestru SPSR dla dzielnika div.
+  */
+#define SPI1WIRE_SPCR_DIV(div)	\
+	((((div) == 8) || ((div) == 16)) ? (1 << SPR0) :	\
+	 (((div) == 32) || ((div) == 64)) ? (1 << SPR1) :	\
+	 ((div) == 128) ? ((1 << SPR1) | (1 << SPR0)) : 0)
+#define SPI1WIRE_SPSR_DIV(div)	\
+	((((div) == 2) || ((div) == 8) || ((div) == 32)) ? (1 << SPI2X) : 0)
+
+/**
+  * Prdko standardowa: najmniejszy dzielnik, dla ktrego bajt 0x00 spenia tLOW0 min
+  */
+#if   (8 * SPI1WIRE_BIT_NS(2)) >= SPI1WIRE_STD_SLOT_MIN_NS
+#define SPI1WIRE_STD_DIV	2
+#elif (8 * SPI1WIRE_BIT_NS(4)) >= SPI1WIRE_STD_SLOT_MIN_NS
+#define SPI1WIRE_STD_DIV	4
+#elif (8 * SPI1WIRE_BIT_NS(8)) >= SPI1WIRE_STD_SLOT_MIN_NS
+#define SPI1WIRE_STD_DIV	8
+#elif (8 * SPI1WIRE_BIT_NS(16)) >= SPI1WIRE_STD_SLOT_MIN_NS
+#define SPI1WIRE_STD_DIV	16
+#elif (8 * SPI1WIRE_BIT_NS(32)) >= SPI1WIRE_STD_SLOT_MIN_NS
+#define SPI1WIRE_STD_DIV	32
+#elif (8 * SPI1WIRE_BIT_NS(64)) >= SPI1WIRE_STD_SLOT_MIN_NS
+#define SPI1WIRE_STD_DIV	64
+#elif (8 * SPI1WIRE_BIT_NS(128)) >= SPI1WIRE_STD_SLOT_MIN_NS
+#define SPI1WIRE_STD_DIV	128
+#else
+#error "F_CPU zbyt duza: szczelina 1-Wire (8 bitow SPI) krotsza niz 60us przy dzielniku 128"
+#define SPI1WIRE_STD_DIV	128
+#endif
+
+/**
+  * Prdko overdrive
+  */
+#if !SPI1WIRE_OVERDRIVE
+#define SPI1WIRE_OD_DIV		SPI1WIRE_STD_DIV
+#elif (8 * SPI1WIRE_BIT_NS(2)) >= SPI1WIRE_OD_SLOT_MIN_NS
+#define SPI1WIRE_OD_DIV		2
+#elif (8 * SPI1WIRE_BIT_NS(4)) >= SPI1WIRE_OD_SLOT_MIN_NS
+#define SPI1WIRE_OD_DIV		4
+#elif (8 * SPI1WIRE_BIT_NS(8)) >= SPI1WIRE_OD_SLOT_MIN_NS
+#define SPI1WIRE_OD_DIV		8
+#elif (8 * SPI1WIRE_BIT_NS(16)) >= SPI1WIRE_OD_SLOT_MIN_NS
+#define SPI1WIRE_OD_DIV		16
+#elif (8 * SPI1WIRE_BIT_NS(32)) >= SPI1WIRE_OD_SLOT_MIN_NS
+#define SPI1WIRE_OD_DIV		32
+#elif (8 * SPI1WIRE_BIT_NS(64)) >= SPI1WIRE_OD_SLOT_MIN_NS
+#define SPI1WIRE_OD_DIV		64
+#else
+#define SPI1WIRE_OD_DIV		128
+#endif
+
+#define SPI1WIRE_STD_BIT_NS		SPI1WIRE_BIT_NS(SPI1WIRE_STD_DIV)	/**< czas bitu SPI [ns] */
+#define SPI1WIRE_OD_BIT_NS		SPI1WIRE_BIT_NS(SPI1WIRE_OD_DIV)
+
+/**< grne oszacowanie czasu szczeliny wraz z wejciem do programu obsugi
+     przerwania [us] (obie prdkoci), podstawa czasu oczekiwania na rozkaz */
+#define SPI1WIRE_SLOT_US_MAX	((8 * SPI1WIRE_STD_BIT_NS + 999) / 1000 + 5)
+
+/**< liczba bitw o stanie niskim rozpoczynajcych szczelin zapisu 1 i odczytu */
+#define SPI1WIRE_STD_LOW1_BITS	((SPI1WIRE_STD_LOW1_MIN_NS + SPI1WIRE_STD_BIT_NS - 1) / SPI1WIRE_STD_BIT_NS)
+#define SPI1WIRE_OD_LOW1_BITS	((SPI1WIRE_OD_LOW1_MIN_NS + SPI1WIRE_OD_BIT_NS - 1) / SPI1WIRE_OD_BIT_NS)
+
+/**< liczba bajtw 0x00 sekwencji RESET oraz 0xFF obserwacji magistrali */
+#define SPI1WIRE_STD_RESET_BYTES	((SPI1WIRE_STD_RESET_NS + 8 * SPI1WIRE_STD_BIT_NS - 1) / (8 * SPI1WIRE_STD_BIT_NS))
+#define SPI1WIRE_STD_RSTH_BYTES		((SPI1WIRE_STD_RSTH_NS + 8 * SPI1WIRE_STD_BIT_NS - 1) / (8 * SPI1WIRE_STD_BIT_NS))
+#define SPI1WIRE_OD_RESET_BYTES		((SPI1WIRE_OD_RESET_NS + 8 * SPI1WIRE_OD_BIT_NS - 1) / (8 * SPI1WIRE_OD_BIT_NS))
+#define SPI1WIRE_OD_RSTH_BYTES		((SPI1WIRE_OD_RSTH_NS + 8 * SPI1WIRE_OD_BIT_NS - 1) / (8 * SPI1WIRE_OD_BIT_NS))
+
+/**
+  * @def wyznaczone parametry sekwencji
+  */
+#define SPI1WIRE_STD_SPCR			SPI1WIRE_SPCR_DIV(SPI1WIRE_STD_DIV)
+#define SPI1WIRE_STD_SPSR			SPI1WIRE_SPSR_DIV(SPI1WIRE_STD_DIV)
+#define SPI1WIRE_OD_SPCR			SPI1WIRE_SPCR_DIV(SPI1WIRE_OD_DIV)
+#define SPI1WIRE_OD_SPSR			SPI1WIRE_SPSR_DIV(SPI1WIRE_OD_DIV)
+
+#define SPI1WIRE_PATTERN_0			0x00		/**< szczelina zapisu 0 (cay bajt) */
+#define SPI1WIRE_STD_PATTERN_1		(0xFF >> SPI1WIRE_STD_LOW1_BITS)	/**< zapis 1 i odczyt */
+#define SPI1WIRE_OD_PATTERN_1		(0xFF >> SPI1WIRE_OD_LOW1_BITS)
+
+/**< maska prbek szczeliny odczytu, wszystkie musz mie stan wysoki dla bitu 1 */
+#define SPI1WIRE_STD_READ_MASK		SPI1WIRE_SAMPLE_MASK(SPI1WIRE_STD_BIT_NS,	\
+                                        SPI1WIRE_STD_LOW1_BITS * SPI1WIRE_STD_BIT_NS + SPI1WIRE_STD_RISE_NS,	\
+                                        SPI1WIRE_STD_SAMPLE_MAX_NS)
+#define SPI1WIRE_OD_READ_MASK		SPI1WIRE_SAMPLE_MASK(SPI1WIRE_OD_BIT_NS,	\
+                                        SPI1WIRE_OD_LOW1_BITS * SPI1WIRE_OD_BIT_NS + SPI1WIRE_OD_RISE_NS,	\
+                                        SPI1WIRE_OD_SAMPLE_MAX_NS)
+
+/**< maska prbek pierwszego bajtu po zwolnieniu magistrali, w ktrych impuls PRESENCE
+     wystpuje niezalenie od tPDH i tPDL: <tPDH max, tPDH min + tPDL min> */
+#define SPI1WIRE_STD_PRESENCE_MASK	SPI1WIRE_SAMPLE_MASK(SPI1WIRE_STD_BIT_NS,	\
+                                        SPI1WIRE_STD_PDH_MAX_NS, SPI1WIRE_STD_PDH_MIN_NS + SPI1WIRE_STD_PDL_MIN_NS)
+#define SPI1WIRE_OD_PRESENCE_MASK	SPI1WIRE_SAMPLE_MASK(SPI1WIRE_OD_BIT_NS,	\
+                                        SPI1WIRE_OD_PDH_MAX_NS, SPI1WIRE_OD_PDH_MIN_NS + SPI1WIRE_OD_PDL_MIN_NS)
+
+/**
+  * Kontrola spenienia wymaga dla wybranych dzielnikw
+  */
+#if (8 * SPI1WIRE_STD_BIT_NS) > SPI1WIRE_STD_SLOT_MAX_NS
+#error "F_CPU: szczelina 1-Wire (predkosc standardowa) dluzsza niz 120us"
+#endif
+#if (SPI1WIRE_STD_LOW1_BITS * SPI1WIRE_STD_BIT_NS) > SPI1WIRE_STD_LOW1_MAX_NS
+#error "F_CPU: impuls zapisu 1 (predkosc standardowa) dluzszy niz 15us"
+#endif
+#if SPI1WIRE_STD_READ_MASK == 0
+#error "F_CPU: brak probki odczytu w szczelinie (predkosc standardowa)"
+#endif
+#if SPI1WIRE_STD_PRESENCE_MASK == 0
+#error "F_CPU: brak probki impulsu PRESENCE (predkosc standardowa)"
+#endif
+#if (SPI1WIRE_STD_RESET_BYTES * 8 * SPI1WIRE_STD_BIT_NS) > SPI1WIRE_STD_RESET_MAX_NS
+#error "F_CPU: impuls RESET (predkosc standardowa) dluzszy niz 960us"
+#endif
+#if (SPI1WIRE_STD_RESET_BYTES + SPI1WIRE_STD_RSTH_BYTES) > SPI1WIRE_RESET_BYTES_MAX
+#error "F_CPU: sekwencja RESET-PULSE-PRESENCE (predkosc standardowa) przekracza 16 bajtow"
+#endif
+
+#if SPI1WIRE_STD_RSTH_BYTES < 3
+#error "F_CPU: obserwacja magistrali po RESET krotsza niz 3 bajty (predkosc standardowa)"
+#endif
+#if SPI1WIRE_STD_RSTH_BYTES > SPI1WIRE_DIAG_SAMPLES
+#error "F_CPU: obserwacja magistrali po RESET (predkosc standardowa) przekracza SPI1WIRE_DIAG_SAMPLES"
+#endif
+
+#if SPI1WIRE_OVERDRIVE
+#if ((8 * SPI1WIRE_OD_BIT_NS) < SPI1WIRE_OD_SLOT_MIN_NS) || ((8 * SPI1WIRE_OD_BIT_NS) > SPI1WIRE_OD_SLOT_MAX_NS)
+#error "F_CPU: brak dzielnika SPI dla szczeliny overdrive (6..16us)"
+#endif
+#if (SPI1WIRE_OD_LOW1_BITS * SPI1WIRE_OD_BIT_NS) > SPI1WIRE_OD_LOW1_MAX_NS
+#error "F_CPU: impuls zapisu 1 (overdrive) dluzszy niz 2us"
+#endif
+#if SPI1WIRE_OD_READ_MASK == 0
+#error "F_CPU: brak probki odczytu w szczelinie overdrive (przed uplywem 2us)"
+#endif
+#if SPI1WIRE_OD_PRESENCE_MASK == 0
+#error "F_CPU: brak probki impulsu PRESENCE (overdrive)"
+#endif
+#if (SPI1WIRE_OD_RESET_BYTES * 8 * SPI1WIRE_OD_BIT_NS) > SPI1WIRE_OD_RESET_MAX_NS
+#error "F_CPU: impuls RESET (overdrive) dluzszy niz 80us"
+#endif
+#if (SPI1WIRE_OD_RESET_BYTES + SPI1WIRE_OD_RSTH_BYTES) > SPI1WIRE_RESET_BYTES_MAX
+#error "F_CPU: sekwencja RESET-PULSE-PRESENCE (overdrive) przekracza 16 bajtow"
+#endif
+#if SPI1WIRE_OD_RSTH_BYTES < 3
+#error "F_CPU: obserwacja magistrali po RESET krotsza niz 3 bajty (overdrive)"
+#endif
+#if SPI1WIRE_OD_RSTH_BYTES > SPI1WIRE_DIAG_SAMPLES
+#error "F_CPU: obserwacja magistrali po RESET (overdrive) przekracza SPI1WIRE_DIAG_SAMPLES"
+#endif
+#endif
+
+#endif //SPI1WIRE_TIMING_H_
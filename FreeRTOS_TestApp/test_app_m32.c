@@ -17,17 +17,21 @@
 #include "semphr.h"
 
 /**< pliki nagwkowe AVR-GCC */
+#include <stddef.h>
+#include <string.h>
 #include <avr/pgmspace.h>
 #include <avr/io.h>
 #include <avr/interrupt.h>
+#include <avr/eeprom.h>
 
 /**< pliki nagwkowe projektu */
 /**< obsuga wywietlacza LCD-HD77480 z interfejsem I2C */
 #include "twi.h"
 #include "pcf8574.h"
 #include "lcd.h"
-/**< obsuga interfejsu 1-Wire z wykorzystaniem SPI */
+/**< obsuga interfejsu 1-Wire z wykorzystaniem SPI i USART */
 #include "spi1wire.h"
+#include "usart1wire.h"
 /**< obsuga czujnika temperatury */
 #include "ds18b20.h"
 /**< funkcje pomocnicze do wywietlania temperatury */
@@ -36,6 +40,13 @@
 /**< podstawowy priorytet zadania */
 #define main_TASK_PRIORITY (tskIDLE_PRIORITY + 1)
 
+/**< rozmiar stosu zadania vMeasureTask [bajty]; najgbsze wywoanie to weryfikacja
+     kopii identyfikatorw (prvLoadRomCache - kopia EEPROM i scratchpad, 43 bajty,
+     prvSpiReadTemperature - ramka MatchROM) zakoczona oczekiwaniem na semaforze
+     sterownika 1-Wire, na stosie zapisywany jest wtedy kontekst zadania i ramka
+     przerwania */
+#define main_MEASURE_STACK_SIZE (configMINIMAL_STACK_SIZE + 115)
+
 
 /**
   * Funkcja inicjalizujca wszystkie ukady peryferyjne
@@ -47,69 +58,699 @@ static void prvInitHardware(void)
 	LCD_Init();
 	
 	SPI1Wire_Init();
+	USART1Wire_Init();
 }
 
 
-/**< kolejka wykorzystywana do przekazywania wartoci temperatury */
+/**< kolejka wykorzystywana do przekazywania wartoci temperatury (xMeasurement) */
 xQueueHandle QueueMeasurement = NULL;
-/**< semafor binarny wykorzystany do sygnalizacji koniecznoci wykonania pomiaru temperatury */
-xSemaphoreHandle SemaphoreStartMeasure = NULL;
 
 
+#if configUSE_IDLE_HOOK == 1
+/**< licznik iteracji zadania IDLE, wykorzystywany do pomiaru czasu procesora
+     zwalnianego przez bibliotek spi1wire.h w trakcie transmisji */
+static volatile uint32_t ulIdleCycleCount = 0;
+/**< czas procesora [us] dostpny dla innych zada w trakcie transmisji
+     ostatniego cyklu ConvertT/ReadScratchpad (podgld w debuggerze) */
+volatile uint32_t ulMeasureFreedTime = 0;
+
+void vApplicationIdleHook(void)
+{
+	portENTER_CRITICAL();
+	ulIdleCycleCount++;
+	portEXIT_CRITICAL();
+}
+
+/**
+  * Funkcja zwracajca stan licznika iteracji zadania IDLE
+  */
+static uint32_t prvGetIdleCycleCount(void);
+static uint32_t prvGetIdleCycleCount(void)
+{
+	uint32_t count;
+
+	portENTER_CRITICAL();
+	count = ulIdleCycleCount;
+	portEXIT_CRITICAL();
+	return count;
+}
+#endif
+
+#if configUSE_TICK_HOOK == 1
+/**< opnienie obsugi taktu systemu: stan licznika Timer1 (zerowanego przy
+     zrwnaniu z OCR1A, preskaler 64 - 4,34us dla 14,7456MHz) w chwili zwikszenia
+     licznika xTickCount; minimum to stay czas wejcia do obsugi taktu, rnica
+     max - min to opnienie wnoszone przez inne przerwania (np. SPI) (podgld
+     w debuggerze). Funkcja vApplicationTickHook wywoywana jest rwnie dla
+     taktu wstrzymanego przez zawieszenie planisty (licznik zwikszany pniej,
+     w xTaskResumeAll) - pomiar uwzgldnia wycznie takty, dla ktrych xTickCount
+     wzrs dokadnie o 1 od poprzedniego wywoania, pozostae zliczane s
+     w usTickDeferred */
+volatile uint16_t usTickLatencyMin = 0xFFFF;
+volatile uint16_t usTickLatencyMax = 0;
+volatile uint16_t usTickDeferred = 0;
+
+void vApplicationTickHook(void)
+{
+	static portTickType xLastTick = 0;
+	portTickType xTick = xTaskGetTickCountFromISR();
+	uint16_t usLatency = TCNT1;
+
+	if ((portTickType)(xTick - xLastTick) == 1)
+	{
+		if (usLatency < usTickLatencyMin) usTickLatencyMin = usLatency;
+		if (usLatency > usTickLatencyMax) usTickLatencyMax = usLatency;
+	}
+	else usTickDeferred++;
+	xLastTick = xTick;
+}
+#endif
+
+
+/**< maksymalna liczba ukadw SLAVE zapamitywanych podczas przeszukiwania magistrali */
+#define main_MAX_SENSORS 4
+
+/**< identyfikatory ROM czujnikw DS18B20 znalezionych na magistrali 1-Wire */
+static uint8_t ucSensorRom[main_MAX_SENSORS][SPI1WIRE_ROM_SIZE];
+static uint8_t ucSensorCount = 0;
+/**< czas przeszukiwania magistrali [tick] (podgld w debuggerze), pozwala porwna
+     kroki przeszukiwania SPI1WIRE_SEARCH_TRIPLET = 1 (jedno przerwanie) i 0 (bit po bicie) */
+volatile portTickType xSearchTime = 0;
+
+/**
+  * Funkcja wyszukujca ukady SLAVE doczone do magistrali 1-Wire (Search ROM)
+  */
+static void prvEnumerateSensors(void);
+static void prvEnumerateSensors(void)
+{
+	/**< stan przeszukiwania poza stosem zadania */
+	static SPI1Wire_Search search;
+	portTickType xStart = xTaskGetTickCount();
+
+	ucSensorCount = 0;
+	for (uint8_t found = SPI1Wire_SearchFirst(&search);
+	     found && (ucSensorCount < main_MAX_SENSORS);
+	     found = SPI1Wire_SearchNext(&search))
+	{
+		/**< pozostae ukady nie s odczytywane jako czujniki temperatury */
+		if (search.rom[0] == DS18B20_FAMILY)
+			memcpy(ucSensorRom[ucSensorCount++], search.rom, SPI1WIRE_ROM_SIZE);
+	}
+	xSearchTime = xTaskGetTickCount() - xStart;
+}
+
+/**< znacznik obecnoci na magistrali ukadw zasilanych pasoytniczo */
+static uint8_t ucParasitePower = 0;
+
+/**
+  * Funkcja sprawdzajca sposb zasilania ukadw SLAVE (ReadPowerSupply)
+  *
+  * Po rozkazie ReadPowerSupply, wysanym do wszystkich ukadw (SkipROM), ukad
+  * zasilany pasoytniczo zwiera magistral w szczelinie odczytu - odczytane 0.
+  */
+static void prvDetectParasitePower(void);
+static void prvDetectParasitePower(void)
+{
+	static const uint8_t readPowerSupply[] = { cmd_DS18x20_SkipROM, cmd_DS18x20_ReadPowerSupply };
+	static const SPI1Wire_Transaction detect = { SPI1WIRE_TR_RESET,
+	                                             readPowerSupply, sizeof(readPowerSupply), NULL, 0 };
+
+	if (SPI1Wire_Execute(&detect) != SPI1WIRE_NO_PRESENCE)
+		ucParasitePower = (SPI1Wire_ReadBit() == 0);
+}
+
+
+/**< liczba magistral 1-Wire: 0 - interfejs SPI, 1 - interfejs USART */
+#define main_BUS_COUNT 2
+
+/**
+  * @def main_CONCURRENT_BUSES
+  *
+  * Sposb rozdziau pomiarw pomidzy magistrale:
+  * - 1 - pomiary na wszystkich magistralach rozpoczynane jednoczenie, kada
+  *       magistrala obsugiwana jest przez wasne zadanie i wasny ukad MASTER,
+  * - 0 - pomiary wykonywane kolejno (wersja odniesienia, do porwnania czasu
+  *       cyklu pomiarowego xRoundTime).
+  */
+#ifndef main_CONCURRENT_BUSES
+#define main_CONCURRENT_BUSES 1
+#endif
+
+/**
+  * @def main_RESOLUTION
+  *
+  * Rozdzielczo pomiaru ustawiana w czujnikach (9..12 bitw); czas oczekiwania
+  * na konwersj (94, 188, 375 lub 750ms) wyznaczany jest z rozdzielczoci
+  * odczytanej z czujnika.
+  */
+#ifndef main_RESOLUTION
+#define main_RESOLUTION 12
+#endif
+
+/**
+  * @def main_POLL_INTERVAL_MS
+  *
+  * Sposb oczekiwania na zakoczenie konwersji:
+  * - > 0 - szczelina odczytu co main_POLL_INTERVAL_MS [ms] (zadanie blokowane
+  *         pomidzy szczelinami), odczyt temperatury tu po zakoczeniu konwersji,
+  *         najpniej po czasie konwersji dla biecej rozdzielczoci; czujniki
+  *         zasilane pasoytniczo obsugiwane s jak dla wartoci 0,
+  * - 0 - stay czas konwersji dla biecej rozdzielczoci (94..750ms).
+  */
+#ifndef main_POLL_INTERVAL_MS
+#define main_POLL_INTERVAL_MS 10
+#endif
+
+/**
+  * Zestaw wynikw jednego cyklu pomiarowego magistrali
+  *
+  * Konwersja we wszystkich czujnikach rozpoczynana jest jednym rozkazem
+  * (SkipROM, ConvertT), dlatego wyniki zestawu maj wsplny znacznik czasu.
+  */
+typedef struct
+{
+	portTickType xTimestamp;					/**< chwila wysania rozkazu ConvertT [tick] */
+	uint8_t ucCount;							/**< liczba wynikw */
+	uint16_t usMeasure[main_MAX_SENSORS];		/**< temperatury, 0xFFFF - brak wyniku */
+} xSampleSet;
+
+/**
+  * Opis magistrali 1-Wire obsugiwanej przez zadanie vMeasureTask
+  *
+  * Stan sterownika (rozkaz, bufory, semafor) przechowywany jest w module
+  * sterownika danego ukadu MASTER (spi1wire.c, usart1wire.c), dziki czemu
+  * transakcje na rnych magistralach mog przebiega rwnoczenie.
+  */
+typedef struct
+{
+	void (*pxInit)(void);						/**< identyfikacja ukadw (moe by NULL) */
+	uint8_t (*pxStartConversion)(void);			/**< RESET, SkipROM, ConvertT;
+	                                                 wynik SPI1WIRE_DIAG_xxx */
+	uint8_t (*pxReadTemperature)(const uint8_t *pucRom, uint8_t *pucScratchpad); /**< RESET,
+	                                                 MatchROM (SkipROM dla pucRom rwnego NULL),
+	                                                 ReadScratchpad, 9 bajtw; 0 - brak ukadu,
+	                                                 bd CRC lub jednolita zawarto */
+	const DS18B20_Bus *pxDevice;				/**< funkcje magistrali dla biblioteki ds18b20.h
+	                                                 (konfiguracja czujnika) */
+	const uint8_t *pucParasitePower;			/**< znacznik zasilania pasoytniczego
+	                                                 (NULL - nie jest sprawdzany) */
+	uint8_t (*pucSensorRom)[SPI1WIRE_ROM_SIZE];	/**< identyfikatory czujnikw znalezionych
+	                                                 na magistrali */
+	const uint8_t *pucSensorCount;				/**< liczba identyfikatorw (NULL lub 0 - jeden
+	                                                 czujnik adresowany rozkazem SkipROM) */
+	xSemaphoreHandle xStart;					/**< danie wykonania pomiaru */
+	xSemaphoreHandle xReady;					/**< zakoczenie identyfikacji i konfiguracji
+	                                                 czujnikw (zwalniany raz) */
+	uint8_t ucScratchpad[DS18B20_SCRATCHPAD_SIZE]; /**< pami RAM czujnika (scratchpad) */
+	uint16_t usConversionTime;					/**< czas konwersji dla rozdzielczoci
+	                                                 czujnikw [ms] */
+	xSampleSet xSamples;						/**< wyniki ostatniego cyklu pomiarowego
+	                                                 (podgld w debuggerze) */
+	volatile portTickType xCycleTime;			/**< czas ostatniego pomiaru [tick] (podgld
+	                                                 w debuggerze) */
+} xSensorBus;
+
+/**
+  * Wynik pomiaru przekazywany przez kolejk QueueMeasurement
+  */
+typedef struct
+{
+	uint8_t ucBus;								/**< numer magistrali */
+	uint8_t ucStatus;							/**< stan magistrali SPI1WIRE_DIAG_xxx */
+	uint16_t usMeasure;							/**< temperatura pierwszego czujnika magistrali,
+	                                                 0xFFFF - brak wyniku */
+} xMeasurement;
+
+/**< rozkaz konwersji wysyany do wszystkich ukadw SLAVE jednoczenie (pominicie
+     adresowania), odczyt wynikw adresowany do kolejnych czujnikw */
+static const uint8_t convertT[] = { cmd_DS18x20_SkipROM, cmd_DS18x20_ConvertT };
+
+/**< wynik ostatniej diagnostycznej sekwencji RESET magistrali SPI (podgld
+     w debuggerze: prbki, pocztek i czas trwania impulsu PRESENCE) */
+static SPI1Wire_Diagnostic xSpiDiagnostic;
+
+/**
+  * Rozpoczcie pomiaru temperatury na magistrali SPI
+  *
+  * Sekwencja RESET wykonywana jest w wersji diagnostycznej, dziki czemu
+  * zwarta lub zablokowana magistrala pomijana jest natychmiast, bez oczekiwania
+  * na zakoczenie konwersji i odczytu zakoczonego bdem CRC. Nieudane
+  * wysanie rozkazu ConvertT rwnie koczy cykl - pami RAM czujnika
+  * zawiera wtedy wynik poprzedniej konwersji z poprawn sum CRC.
+  */
+static uint8_t prvSpiStartConversion(void);
+static uint8_t prvSpiStartConversion(void)
+{
+	static const SPI1Wire_Transaction startConversion = { 0, convertT, sizeof(convertT), NULL, 0 };
+	/**< dla ukadw zasilanych pasoytniczo silne podciganie zaczane jest
+	     w programie obsugi przerwania bezporednio po ostatnim bicie ConvertT
+	     i podtrzymywane do rozpoczcia kolejnej transakcji (odczytu) */
+	static const SPI1Wire_Transaction startConversionParasite = { SPI1WIRE_TR_PULLUP,
+	                                                              convertT, sizeof(convertT), NULL, 0 };
+	uint8_t ucStatus = SPI1Wire_ResetDiagnostic(&xSpiDiagnostic);
+
+	if ((ucStatus < SPI1WIRE_DIAG_NO_PRESENCE) &&
+	    (SPI1Wire_Execute(ucParasitePower ? &startConversionParasite : &startConversion) ==
+	     SPI1WIRE_NO_PRESENCE))
+	{
+		/**< przekroczony czas lub bd sterownika (SPI1Wire_GetError) */
+		ucStatus = (SPI1Wire_GetError() != SPI1WIRE_ERR_NONE) ? SPI1WIRE_DIAG_FAULT :
+		                                                        SPI1WIRE_DIAG_NO_PRESENCE;
+	}
+	return ucStatus;
+}
+
+#if SPI1WIRE_CAPTURE
+/**< prbki wszystkich szczelin ostatniego odczytu z magistrali SPI (podgld
+     w debuggerze): sekwencja RESET-PULSE (maks. 16 szczelin), rozkazy oraz
+     72 szczeliny odczytu */
+static SPI1Wire_SlotCapture xSpiCapture[16 + 8 * (SPI1WIRE_ROM_SIZE + 2 + DS18B20_SCRATCHPAD_SIZE)];
+static volatile uint16_t usSpiCaptureLength = 0;
+#endif
+
+/**
+  * Odczyt temperatury z magistrali SPI
+  */
+static uint8_t prvSpiReadTemperature(const uint8_t *pucRom, uint8_t *pucScratchpad);
+static uint8_t prvSpiReadTemperature(const uint8_t *pucRom, uint8_t *pucScratchpad)
+{
+	uint8_t ucFrame[1 + SPI1WIRE_ROM_SIZE + 1];
+	uint8_t ucLength = 0;
+	uint8_t ucResult;
+
+	/**< adresowanie i rozkaz ReadScratchpad wysyane w jednej transakcji */
+	if (pucRom != NULL)
+	{
+		ucFrame[ucLength++] = cmd_DS18x20_MatchROM;
+		memcpy(&ucFrame[ucLength], pucRom, SPI1WIRE_ROM_SIZE);
+		ucLength += SPI1WIRE_ROM_SIZE;
+	}
+	else ucFrame[ucLength++] = cmd_DS18x20_SkipROM;
+	ucFrame[ucLength++] = cmd_DS18x20_ReadScratchpad;
+
+	const SPI1Wire_Transaction readTemperature = { SPI1WIRE_TR_RESET, ucFrame, ucLength,
+	                                               pucScratchpad, DS18B20_SCRATCHPAD_SIZE };
+
+#if SPI1WIRE_CAPTURE
+	SPI1Wire_CaptureStart(xSpiCapture, sizeof(xSpiCapture) / sizeof(xSpiCapture[0]));
+#endif
+	/**< suma CRC8 wyznaczana jest w trakcie odczytu, w programie obsugi przerwania;
+	     zwarta magistrala daje same zera, dla ktrych suma CRC rwnie wynosi 0 */
+	ucResult = (SPI1Wire_Execute(&readTemperature) != SPI1WIRE_NO_PRESENCE) &&
+	           (SPI1Wire_GetCRC8() == 0) && DS18B20_ScratchpadValid(pucScratchpad);
+#if SPI1WIRE_CAPTURE
+	usSpiCaptureLength = SPI1Wire_CaptureStop();
+#endif
+	return ucResult;
+}
+
+/**< maska prbkowania szczelin odczytu wyznaczona dla magistrali SPI (podgld
+     w debuggerze), 0 - kalibracja nieudana, stosowana maska domylna */
+static volatile uint8_t ucSpiReadMask = 0;
+
+/**
+  * Kopia identyfikatorw czujnikw magistrali SPI w pamici EEPROM
+  *
+  * Po wczeniu zasilania na magistrali s zwykle te same ukady, dlatego
+  * zamiast przeszukiwania magistrali (Search ROM) sprawdzana jest obecno
+  * zapamitanych czujnikw. Kalibracja prbkowania (rwnie przeszukiwanie
+  * magistrali) zastpowana jest zapamitan mask. Suma CRC8 obejmuje
+  * wszystkie pola poza ni sam.
+  */
+typedef struct
+{
+	uint8_t ucCount;							/**< liczba identyfikatorw */
+	uint8_t ucRom[main_MAX_SENSORS][SPI1WIRE_ROM_SIZE];
+	uint8_t ucReadMask;							/**< wynik SPI1Wire_Calibrate (0 - maska
+	                                                 domylna) */
+	uint8_t ucCrc;								/**< suma CRC8 poprzednich pl */
+} xRomCache;
+
+static xRomCache xRomCacheEE EEMEM;
+
+/**< rdo identyfikatorw czujnikw magistrali SPI (podgld w debuggerze):
+     1 - kopia w EEPROM, 0 - przeszukiwanie magistrali */
+static volatile uint8_t ucRomCacheHit = 0;
+/**< czas od uruchomienia systemu do pierwszego poprawnego wyniku na magistrali
+     SPI [tick] (podgld w debuggerze), pozwala porwna start z aktualn
+     i nieaktualn kopi identyfikatorw */
+volatile portTickType xFirstSampleTime = 0;
+
+/**
+  * Odczyt identyfikatorw z pamici EEPROM i ich weryfikacja na magistrali
+  *
+  * Przywracana jest zapamitana maska prbkowania, nastpnie kady zapamitany
+  * czujnik wybierany jest rozkazem Match ROM i odczytywana jest jego pami RAM
+  * (scratchpad) - poprawna suma CRC i niejednolita zawarto
+  * (prvSpiReadTemperature) potwierdzaj obecno wanie tego ukadu.
+  *
+  * @return 0 - kopia nieaktualna (bd CRC, brak ktrego z czujnikw),
+  *         w przeciwnym razie identyfikatory przepisane do ucSensorRom
+  */
+static uint8_t prvLoadRomCache(void);
+static uint8_t prvLoadRomCache(void)
+{
+	xRomCache xCache;
+	uint8_t ucScratchpad[DS18B20_SCRATCHPAD_SIZE];
+
+	eeprom_read_block(&xCache, &xRomCacheEE, sizeof(xCache));
+	if ((xCache.ucCount == 0) || (xCache.ucCount > main_MAX_SENSORS) ||
+	    (SPI1Wire_CRC8((const uint8_t *)&xCache, offsetof(xRomCache, ucCrc)) != xCache.ucCrc))
+		return 0;
+	SPI1Wire_SetReadMask(xCache.ucReadMask);
+	for (uint8_t i = 0; i < xCache.ucCount; i++)
+	{
+		if (!prvSpiReadTemperature(xCache.ucRom[i], ucScratchpad)) return 0;
+	}
+	ucSpiReadMask = xCache.ucReadMask;
+	memcpy(ucSensorRom, xCache.ucRom, sizeof(ucSensorRom));
+	ucSensorCount = xCache.ucCount;
+	return 1;
+}
+
 /**
-  * Zadanie realizujce pomiar temperatury
+  * Zapis identyfikatorw znalezionych podczas przeszukiwania w pamici EEPROM
+  *
+  * Zapisywane s wycznie zmienione bajty (eeprom_update_block).
+  */
+static void prvSaveRomCache(void);
+static void prvSaveRomCache(void)
+{
+	xRomCache xCache;
+
+	memset(&xCache, 0, sizeof(xCache));
+	xCache.ucCount = ucSensorCount;
+	memcpy(xCache.ucRom, ucSensorRom, sizeof(xCache.ucRom));
+	xCache.ucReadMask = ucSpiReadMask;
+	xCache.ucCrc = SPI1Wire_CRC8((const uint8_t *)&xCache, offsetof(xRomCache, ucCrc));
+	eeprom_update_block(&xCache, &xRomCacheEE, sizeof(xCache));
+}
+
+/**
+  * Identyfikacja ukadw, sposobu ich zasilania oraz kalibracja prbkowania
+  * szczelin odczytu na magistrali SPI
+  */
+static void prvSpiInit(void);
+static void prvSpiInit(void)
+{
+	/**< kalibracja i pene przeszukiwanie magistrali wycznie dla nieaktualnej
+	     kopii identyfikatorw; brak czujnikw nie jest zapamitywany */
+	ucRomCacheHit = prvLoadRomCache();
+	if (!ucRomCacheHit)
+	{
+		/**< kalibracja przed przeszukiwaniem - duga magistrala z domyln mask
+		     moe nie pozwoli na poprawny odczyt identyfikatorw (CRC); nieudana
+		     kalibracja nie zmienia maski, dlatego maska z kopii jest odrzucana */
+		SPI1Wire_SetReadMask(0);
+		ucSpiReadMask = SPI1Wire_Calibrate();
+		prvEnumerateSensors();
+		if (ucSensorCount != 0) prvSaveRomCache();
+	}
+	prvDetectParasitePower();
+}
+
+/**< wynik sekwencji RESET magistrali USART przekazywany jest bez zmian jako
+     stan SPI1WIRE_DIAG_xxx */
+#if (USART1WIRE_DIAG_OK != SPI1WIRE_DIAG_OK) || (USART1WIRE_DIAG_NO_PRESENCE != SPI1WIRE_DIAG_NO_PRESENCE) || \
+    (USART1WIRE_DIAG_SHORT != SPI1WIRE_DIAG_SHORT) || (USART1WIRE_DIAG_FAULT != SPI1WIRE_DIAG_FAULT)
+#error "USART1WIRE_DIAG_xxx niezgodne z SPI1WIRE_DIAG_xxx"
+#endif
+
+/**
+  * Rozpoczcie pomiaru temperatury na magistrali USART
+  *
+  * Zwarta magistrala (SPI1WIRE_DIAG_SHORT) pomijana jest jak brak odpowiedzi,
+  * bez oczekiwania na konwersj; przekroczony czas wysania rozkazu ConvertT
+  * (USART1Wire_GetError) kodowany jest jako SPI1WIRE_DIAG_FAULT.
+  */
+static uint8_t prvUsartStartConversion(void);
+static uint8_t prvUsartStartConversion(void)
+{
+	uint8_t ucStatus = USART1Wire_ResetDiagnostic();
+
+	if (ucStatus < SPI1WIRE_DIAG_NO_PRESENCE)
+	{
+		USART1Wire_WriteBlock(convertT, sizeof(convertT));
+		if (USART1Wire_GetError() != USART1WIRE_ERR_NONE) ucStatus = SPI1WIRE_DIAG_FAULT;
+	}
+	return ucStatus;
+}
+
+/**< funkcje magistral dla biblioteki ds18b20.h */
+static const DS18B20_Bus xSpiDevice = { SPI1Wire_ResetPresence, SPI1Wire_WriteBlock,
+                                        SPI1Wire_ReadBlock, SPI1Wire_ReadBit };
+static const DS18B20_Bus xUsartDevice = { USART1Wire_ResetPresence, USART1Wire_WriteBlock,
+                                          USART1Wire_ReadBlock, USART1Wire_ReadBit };
+
+/**
+  * Odczyt temperatury z magistrali USART
+  *
+  * Przekroczony czas dowolnej sekwencji (USART1Wire_GetError) oznacza
+  * niekompletny odczyt i kodowany jest jak brak ukadu.
+  */
+static uint8_t prvUsartReadTemperature(const uint8_t *pucRom, uint8_t *pucScratchpad);
+static uint8_t prvUsartReadTemperature(const uint8_t *pucRom, uint8_t *pucScratchpad)
+{
+	return DS18B20_ReadScratchpad(&xUsartDevice, pucRom, pucScratchpad) &&
+	       (USART1Wire_GetError() == USART1WIRE_ERR_NONE);
+}
+
+/**< magistrale 1-Wire, kolejno zgodna z numerem magistrali */
+static xSensorBus xBuses[main_BUS_COUNT] =
+{
+	{ prvSpiInit, prvSpiStartConversion, prvSpiReadTemperature, &xSpiDevice, &ucParasitePower,
+	  ucSensorRom, &ucSensorCount },
+	{ NULL, prvUsartStartConversion, prvUsartReadTemperature, &xUsartDevice, NULL,
+	  NULL, NULL }
+};
+
+/**< czas ostatniego cyklu pomiarowego wszystkich magistral [tick] (podgld
+     w debuggerze), pozwala porwna main_CONCURRENT_BUSES = 1 i 0 */
+volatile portTickType xRoundTime = 0;
+
+
+/**
+  * Oczekiwanie na zakoczenie konwersji temperatury
+  *
+  * Szczeliny odczytu wykonywane s co main_POLL_INTERVAL_MS, czas oczekiwania
+  * ograniczony jest czasem konwersji dla biecej rozdzielczoci czujnika.
+  */
+static void prvWaitConversion(xSensorBus *pxBus);
+static void prvWaitConversion(xSensorBus *pxBus)
+{
+	portTickType xConversion = pxBus->usConversionTime / portTICK_RATE_MS;
+#if main_POLL_INTERVAL_MS
+	portTickType xStart = xTaskGetTickCount();
+
+	/**< silne podciganie magistrali nie moe zosta przerwane szczelin odczytu */
+	if ((pxBus->pucParasitePower == NULL) || (*pxBus->pucParasitePower == 0))
+	{
+		do
+		{
+			vTaskDelay(main_POLL_INTERVAL_MS / portTICK_RATE_MS);
+			if (DS18B20_ConversionDone(pxBus->pxDevice)) return;
+		} while ((portTickType)(xTaskGetTickCount() - xStart) < xConversion);
+		return;
+	}
+#endif
+	vTaskDelay(xConversion);
+}
+
+/**
+  * Liczba czujnikw magistrali adresowanych identyfikatorem ROM
+  */
+static uint8_t prvSensorCount(const xSensorBus *pxBus);
+static uint8_t prvSensorCount(const xSensorBus *pxBus)
+{
+	return (pxBus->pucSensorCount != NULL) ? *pxBus->pucSensorCount : 0;
+}
+
+/**
+  * Ustawienie rozdzielczoci pomiaru we wszystkich czujnikach magistrali
+  *
+  * Czas konwersji wyznaczany jest dla najwyszej rozdzielczoci odczytanej
+  * z czujnikw; brak odpowiedzi wszystkich czujnikw - czas dla 12 bitw.
+  */
+static void prvConfigureSensors(xSensorBus *pxBus);
+static void prvConfigureSensors(xSensorBus *pxBus)
+{
+	uint8_t ucCount = prvSensorCount(pxBus);
+	uint8_t ucResolution = 0;
+
+	for (uint8_t i = 0; i < ((ucCount != 0) ? ucCount : 1); i++)
+	{
+		uint8_t ucBits = DS18B20_SetResolution(pxBus->pxDevice,
+		                                       (ucCount != 0) ? pxBus->pucSensorRom[i] : NULL,
+		                                       main_RESOLUTION, 0);
+
+		if (ucBits > ucResolution) ucResolution = ucBits;
+	}
+	pxBus->usConversionTime = DS18B20_ConversionTime(ucResolution);
+}
+
+/**
+  * Odczyt wynikw wszystkich czujnikw magistrali po wsplnej konwersji
+  *
+  * Czujniki znalezione podczas przeszukiwania odczytywane s kolejno
+  * (MatchROM), bez identyfikatorw - jeden odczyt (SkipROM). Czas konwersji
+  * kolejnego cyklu wyznaczany jest dla najwyszej rozdzielczoci odczytanej
+  * z czujnikw (np. wymienionych lub po zaniku zasilania - konfiguracja
+  * z EEPROM); bd transmisji (CRC) kodowany jest jak brak ukadu.
+  */
+static void prvReadSamples(xSensorBus *pxBus);
+static void prvReadSamples(xSensorBus *pxBus)
+{
+	uint8_t ucCount = prvSensorCount(pxBus);
+	uint8_t ucResolution = 0;
+
+	pxBus->xSamples.ucCount = (ucCount != 0) ? ucCount : 1;
+	for (uint8_t i = 0; i < pxBus->xSamples.ucCount; i++)
+	{
+		if (pxBus->pxReadTemperature((ucCount != 0) ? pxBus->pucSensorRom[i] : NULL,
+		                             pxBus->ucScratchpad))
+		{
+			uint8_t ucBits = DS18B20_GetResolution(pxBus->ucScratchpad);
+
+			pxBus->xSamples.usMeasure[i] = DS18B20_GetTemperature(pxBus->ucScratchpad);
+			if (ucBits > ucResolution) ucResolution = ucBits;
+		}
+		else pxBus->xSamples.usMeasure[i] = 0xFFFF;
+	}
+	if (ucResolution != 0) pxBus->usConversionTime = DS18B20_ConversionTime(ucResolution);
+}
+
+/**
+  * Zadanie realizujce pomiar temperatury na jednej magistrali 1-Wire
   *
   * Stanowi element posredniczcy pomidzy aplikacj uytkow (zadania uytkowe) a funkcjami
-  * niskopoziomowymi z biblioteki spi1wire.h.
+  * niskopoziomowymi z bibliotek spi1wire.h i usart1wire.h. Dla kadej magistrali
+  * tworzone jest osobne zadanie (parametr - wskanik na xSensorBus).
   *
   */
 static void vMeasureTask(void *pvParameters);
 static void vMeasureTask(void *pvParameters)
 {
-	( void ) pvParameters;
+	xSensorBus *pxBus = (xSensorBus *) pvParameters;
+	xMeasurement xResult;
+	portTickType xStart;
+#if configUSE_IDLE_HOOK == 1
+	/**< stany licznika iteracji zadania IDLE na granicach etapw pomiaru
+	     (pomiar wycznie dla magistrali SPI) */
+	uint32_t ulIdleStart, ulIdleConvert, ulIdleWait, ulIdleRead;
+	portTickType xWaitStart;
+	uint16_t usWait;
+#endif
 
-	/**< zmienna wykorzystywana do przechowywania wyniku pomiaru temperatury */
-	uint16_t measure = 0;
+	xResult.ucBus = pxBus - xBuses;
+	/**< identyfikacja ukadw doczonych do magistrali oraz sposobu ich zasilania */
+	if (pxBus->pxInit != NULL) pxBus->pxInit();
+	prvConfigureSensors(pxBus);
+	xSemaphoreGive(pxBus->xReady);
 	
 	for( ;; )
 	{
 		/**< oczekiwanie na danie wykonania pomiaru */
-		if (xSemaphoreTake(SemaphoreStartMeasure, portMAX_DELAY))
+		if (xSemaphoreTake(pxBus->xStart, portMAX_DELAY))
 		{
-			/**< zerowanie oraz sprawdzenie dostpnoci ukadu SLAVE
-			     na magistrali 1-Wire */
-			if (SPI1Wire_ResetPresence() != SPI1WIRE_NO_PRESENCE)
+			xStart = xTaskGetTickCount();
+#if configUSE_IDLE_HOOK == 1
+			ulIdleStart = prvGetIdleCycleCount();
+#endif
+			/**< zerowanie, sprawdzenie dostpnoci ukadu SLAVE na magistrali 1-Wire
+			     oraz wysanie rozkazu inicjujcego pomiar temperatury */
+			xResult.ucStatus = pxBus->pxStartConversion();
+			pxBus->xSamples.xTimestamp = xTaskGetTickCount();
+			if (xResult.ucStatus < SPI1WIRE_DIAG_NO_PRESENCE)
 			{
-				/**< pominicie adresowania ukadu SLAVE, z zaoenia jest tylko jeden */
-  				SPI1Wire_Write(cmd_DS18x20_SkipROM);
-				/**< wysanie rozkazu inicjujcego pomiar temperatury w ukadzie SLAVE*/
-				SPI1Wire_Write(cmd_DS18x20_ConvertT);
-				/**< oczekiwanie na zakoczenie pomiaru, typowo czas ten nie przekracza 750ms */
-				vTaskDelay(750 / portTICK_RATE_MS);
-
-				/**< odczyt temperatury, wysanie rozkazu RESET */
-				SPI1Wire_ResetPresence();
-				/**< pominicie adresowania ukadu SLAVE */
-				SPI1Wire_Write(cmd_DS18x20_SkipROM);
-				/**< odczyt pamici RAM czujnika, pierwsze dwa bajty to temperatura */
-				SPI1Wire_Write(cmd_DS18x20_ReadScratchpad);
-				uint8_t tempL = SPI1Wire_Read();
-				uint8_t tempH = SPI1Wire_Read();
-				/**< odczytana warto temperatury */
-				measure = (tempH << 8) + tempL;
+#if configUSE_IDLE_HOOK == 1
+				ulIdleConvert = prvGetIdleCycleCount();
+				xWaitStart = xTaskGetTickCount();
+#endif
+				/**< oczekiwanie na zakoczenie pomiaru, czas zaley od rozdzielczoci
+				     (maks. 750ms dla 12 bitw); w tym czasie pozostae magistrale mog
+				     realizowa wasne transakcje */
+				prvWaitConversion(pxBus);
+#if configUSE_IDLE_HOOK == 1
+				ulIdleWait = prvGetIdleCycleCount();
+				usWait = (xTaskGetTickCount() - xWaitStart) * portTICK_RATE_MS;
+#endif
+
+				/**< odczyt temperatury: RESET, MatchROM lub SkipROM, ReadScratchpad,
+				     odczyt 9 bajtw - dla kadego czujnika; cykl trwa jeden czas
+				     konwersji oraz N krtkich odczytw */
+				prvReadSamples(pxBus);
+				xResult.usMeasure = pxBus->xSamples.usMeasure[0];
+				if ((xResult.ucBus == 0) && (xFirstSampleTime == 0) && (xResult.usMeasure != 0xFFFF))
+					xFirstSampleTime = xTaskGetTickCount();
+#if configUSE_IDLE_HOOK == 1
+				ulIdleRead = prvGetIdleCycleCount();
+				/**< liczba iteracji zadania IDLE w czasie oczekiwania na konwersj (procesor
+				     w peni dostpny) pozwala przeliczy iteracje zarejestrowane w trakcie
+				     transmisji na czas; przy aktywnym oczekiwaniu wynik jest bliski zeru */
+				if ((xResult.ucBus == 0) && (ulIdleWait != ulIdleConvert))
+					ulMeasureFreedTime = ((ulIdleConvert - ulIdleStart) + (ulIdleRead - ulIdleWait)) *
+					                     (usWait * 1000ULL) / (ulIdleWait - ulIdleConvert);
+#endif
 			}
 			else
+			{
 			    /**< brak ukadu SLAVE lub nie odpowiada kodowana jako -1 (lub 0xFFFF),
-				     nie moe by 0, bo warto ta moe okrela temperatur 0C */
-				measure = 0xFFFF;
+				     nie moe by 0, bo warto ta moe okrela temperatur 0C;
+				     przyczyna (np. zwarcie magistrali) w polu ucStatus */
+				xResult.usMeasure = 0xFFFF;
+				pxBus->xSamples.ucCount = 0;
+			}
+			pxBus->xCycleTime = xTaskGetTickCount() - xStart;
 
 			/**< umieszczenie wartoci temperatury w kolejce */
-			xQueueSend(QueueMeasurement, &measure, 10 / portTICK_RATE_MS);
+			xQueueSend(QueueMeasurement, &xResult, 10 / portTICK_RATE_MS);
 		}
 	}
 }
 
 
+#if SPI1WIRE_TRACE
+/**< statystyki zdarze programu obsugi przerwania od SPI (podgld w debuggerze):
+     najduszy odstp pomidzy kolejnymi szczelinami rozkazu [takty Timer1,
+     4,34us; szczelina bez przerwy to ok. 16] oraz liczba pominitych wpisw */
+volatile uint16_t usTraceIntervalMax = 0;
+volatile uint16_t usTraceDropped = 0;
+
+/**
+  * Zadanie oprniajce bufor zdarze biblioteki spi1wire.h
+  *
+  * Bufor odczytywany jest co takt systemu (ok. 14 szczelin przy prdkoci
+  * standardowej), dlatego SPI1WIRE_TRACE_SIZE 16 wystarcza do rejestracji
+  * wszystkich szczelin.
+  */
+static void vTraceTask(void *pvParameters);
+static void vTraceTask(void *pvParameters)
+{
+	SPI1Wire_TraceEntry xEntry, xPrevious = { 0 };
+
+	( void ) pvParameters;
+
+	for( ;; )
+	{
+		while (SPI1Wire_TraceRead(&xEntry))
+		{
+			/**< odstp liczony wycznie dla szczeliny rozpocztej w poprzednim
+			     wywoaniu programu obsugi przerwania (ta sama transakcja) */
+			if (xPrevious.action & 0x80)
+			{
+				uint16_t usInterval = (uint8_t)(xEntry.tick - xPrevious.tick) * (OCR1A + 1) +
+				                      xEntry.time - xPrevious.time;
+
+				if (usInterval > usTraceIntervalMax) usTraceIntervalMax = usInterval;
+			}
+			xPrevious = xEntry;
+		}
+		usTraceDropped += SPI1Wire_TraceDropped();
+		vTaskDelay(1);
+	}
+}
+#endif
+
 /**
   * Zadanie gwne wywietlajce temperatur
   *
@@ -118,50 +759,91 @@ static void vDisplayTask(void *pvParameters);
 static void vDisplayTask(void *pvParameters)
 {
 	( void ) pvParameters;
+
+	/**< oczekiwanie na gotowo wszystkich magistral - przeszukiwanie i kalibracja
+	     trwaj duej ni czas oczekiwania na wynik pomiaru */
+	for (uint8_t i = 0; i < main_BUS_COUNT; i++)
+		xSemaphoreTake(xBuses[i].xReady, portMAX_DELAY);
 	
 	for( ;; )
 	{
-		/**< wysanie dania wykonania pomiaru temperatury */
-		xSemaphoreGive(SemaphoreStartMeasure);
-		
-		uint16_t measure;
-		
+		portTickType xStart = xTaskGetTickCount();
+		xMeasurement xResult;
+
+#if main_CONCURRENT_BUSES
+		/**< wysanie dania wykonania pomiaru temperatury na wszystkich magistralach,
+		     czas oczekiwania na konwersj jest wsplny */
+		for (uint8_t i = 0; i < main_BUS_COUNT; i++)
+			xSemaphoreGive(xBuses[i].xStart);
+#endif
+
 		LCD_Clear();
 
-		/**< pobranie wartoci temperatury */
-		if (xQueueReceive(QueueMeasurement, &measure, 800 / portTICK_RATE_MS))
+		for (uint8_t i = 0; i < main_BUS_COUNT; i++)
 		{
-			if (measure != 0xFFFF)
+#if !main_CONCURRENT_BUSES
+			/**< pomiar na kolejnej magistrali po zakoczeniu poprzedniego */
+			xSemaphoreGive(xBuses[i].xStart);
+#endif
+			/**< pobranie wartoci temperatury (z dowolnej magistrali) */
+			if (xQueueReceive(QueueMeasurement, &xResult, 800 / portTICK_RATE_MS))
 			{
-				/**< sprawdzenie czy wynik pomiaru jest liczb ujemn,
-				     wywietlenie znaku i ew. wyznaczenie moduu */
-				if ((measure & 0x8000) != 0)
+				/**< wiersz wywietlacza odpowiada numerowi magistrali */
+				LCD_GoTo(0, xResult.ucBus);
+				uint16_t measure = xResult.usMeasure;
+
+				if (measure != 0xFFFF)
+				{
+					/**< sprawdzenie czy wynik pomiaru jest liczb ujemn,
+					     wywietlenie znaku i ew. wyznaczenie moduu */
+					if ((measure & 0x8000) != 0)
+					{
+						LCDPutChar('-');
+						measure = ~measure + 1;
+					}
+					else
+					{
+						LCDPutChar('+');
+					}
+
+					/**< wywietlenie wartoci cakowitej */
+					LCDWriteInteger(measure >> 4);	
+
+					LCDPutChar('.');
+
+					/**< wywietlenie wartoci uamkowej */
+					LCDWriteFractional(measure & 0x0F);
+					LCDPutChar('C');
+				}
+				else if (xResult.ucStatus == SPI1WIRE_DIAG_SHORT)
 				{
-					LCDPutChar('-');
-					measure = ~measure + 1;
+					/**< stan niski przed sekwencj RESET */
+					LCDPutsCode("Bus shorted!");
+				}
+				else if (xResult.ucStatus == SPI1WIRE_DIAG_STUCK_LOW)
+				{
+					/**< magistrala nie powraca do stanu wysokiego po impulsie PRESENCE */
+					LCDPutsCode("Bus stuck low!");
+				}
+				else if (xResult.ucStatus == SPI1WIRE_DIAG_FAULT)
+				{
+					/**< przekroczony czas lub bd sterownika (SPI1Wire_GetError) */
+					LCDPutsCode("1-Wire fault!");
 				}
 				else
 				{
-					LCDPutChar('+');
+					/**< brak ukadu SLAVE lub nie odpowiada */
+					LCDPutsCode("No DS18B20 found!");
 				}
-
-				/**< wywietlenie wartoci cakowitej */
-				LCDWriteInteger(measure >> 4);	
-
-				LCDPutChar('.');
-
-				/**< wywietlenie wartoci uamkowej */
-				LCDWriteFractional(measure & 0x0F);
-				LCDPutChar('C');
 			}
+			/**< zadanie vMeasureTask nie odpowiada */
 			else
 			{
-				/**< brak ukadu SLAVE lub nie odpowiada */
-				LCDPutsCode("No DS18B20 found!");
+				LCD_GoTo(0, i);
+				LCDPutsCode("Time out");
 			}
 		}
-		/**< zadanie vMeasureTask nie odpowiada */
-		else LCDPutsCode("Time out");
+		xRoundTime = xTaskGetTickCount() - xStart;
 		
 		/**< aktualizacja wywietlacza co ok. 2 sek. */
 		vTaskDelay(1250 / portTICK_RATE_MS);
@@ -174,12 +856,17 @@ void main(void)
 	/**< inicjalizacja ukadw peryferyjnych */
 	prvInitHardware();
 
-	/**< utworzenie kolejki i semafora binarnego */
-	QueueMeasurement = xQueueCreate(5, sizeof(uint16_t));
-	vSemaphoreCreateBinary(SemaphoreStartMeasure);
-	/**< wstpne zrowanie semafora, poprzednie wersje FreeRTOS-a ustawiay
-	     go od razu po utworzeniu */
-	xSemaphoreTake(SemaphoreStartMeasure, 0 / portTICK_RATE_MS);
+	/**< utworzenie kolejki i semaforw binarnych (dwa na magistral) */
+	QueueMeasurement = xQueueCreate(5, sizeof(xMeasurement));
+	for (uint8_t i = 0; i < main_BUS_COUNT; i++)
+	{
+		vSemaphoreCreateBinary(xBuses[i].xStart);
+		vSemaphoreCreateBinary(xBuses[i].xReady);
+		/**< wstpne zrowanie semaforw, poprzednie wersje FreeRTOS-a ustawiay
+		     je od razu po utworzeniu */
+		xSemaphoreTake(xBuses[i].xStart, 0 / portTICK_RATE_MS);
+		xSemaphoreTake(xBuses[i].xReady, 0 / portTICK_RATE_MS);
+	}
 	
 	/**< utworzenie zada */
 	xTaskCreate(vDisplayTask,
@@ -189,12 +876,24 @@ void main(void)
 				main_TASK_PRIORITY + 1,
 				NULL);
 
-	xTaskCreate(vMeasureTask,
-				(const int8_t*) "lcd",
+	for (uint8_t i = 0; i < main_BUS_COUNT; i++)
+	{
+		xTaskCreate(vMeasureTask,
+					(const int8_t*) "1w",
+					main_MEASURE_STACK_SIZE,
+					&xBuses[i],
+					main_TASK_PRIORITY,
+					NULL);
+	}
+
+#if SPI1WIRE_TRACE
+	xTaskCreate(vTraceTask,
+				(const int8_t*) "trc",
 				configMINIMAL_STACK_SIZE,
 				NULL,
 				main_TASK_PRIORITY,
 				NULL);
+#endif
 
 	/**< uruchomienie systemu operacyjnego */
 	vTaskStartScheduler();
@@ -0,0 +1,343 @@
+/** @file usart1wire.c
+  */
+
+#include <stddef.h>
+
+#include "main.h"
+#include "usart1wire.h"
+
+#if !USART1WIRE_USE_FREERTOS
+#include <util/delay.h>
+#endif
+
+#if USART1WIRE_USE_FREERTOS
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+/**< semafor binarny sygnalizujcy zakoczenie sekwencji interfejsu 1-Wire */
+static xSemaphoreHandle usart_1wire_ready = NULL;
+#endif
+
+#ifndef F_CPU
+#error "F_CPU nie zostala zdefiniowana"
+#endif
+
+/**
+  * @def wartoci rejestru UBRR (tryb asynchroniczny, U2X = 0) oraz uzyskiwana
+  *      prdko; dla 14,7456MHz obie prdkoci s dokadne
+  */
+#define USART1WIRE_UBRR(baud)		((F_CPU + 8UL * (baud)) / (16UL * (baud)) - 1)
+#define USART1WIRE_ACTUAL(baud)		(F_CPU / (16UL * (USART1WIRE_UBRR(baud) + 1)))
+#define USART1WIRE_UBRR_RESET		USART1WIRE_UBRR(USART1WIRE_BAUD_RESET)
+#define USART1WIRE_UBRR_SLOT		USART1WIRE_UBRR(USART1WIRE_BAUD_SLOT)
+
+/**
+  * @def czas ramki 8N1 (10 bitw) [us], zaokrglony w gr: 87us dla szczeliny,
+  *      1042us dla sekwencji RESET
+  */
+#define USART1WIRE_FRAME_US(baud)	((10UL * 1000000UL + (baud) - 1) / (baud))
+
+/**< szczelina 115200 bodw: 0x00 to 78us (tLOW0 60..120us), 0xFF 8,7us (tLOW1 < 15us),
+     prbka odczytu w poowie bitu 0 - 13us; dopuszczalny bd prdkoci 3% */
+#if (USART1WIRE_ACTUAL(USART1WIRE_BAUD_SLOT) * 100UL > USART1WIRE_BAUD_SLOT * 103UL) || \
+    (USART1WIRE_ACTUAL(USART1WIRE_BAUD_SLOT) * 100UL < USART1WIRE_BAUD_SLOT * 97UL)
+#error "USART1WIRE: predkosc 115200 bodow niedostepna dla F_CPU"
+#endif
+#if (USART1WIRE_ACTUAL(USART1WIRE_BAUD_RESET) * 100UL > USART1WIRE_BAUD_RESET * 103UL) || \
+    (USART1WIRE_ACTUAL(USART1WIRE_BAUD_RESET) * 100UL < USART1WIRE_BAUD_RESET * 97UL)
+#error "USART1WIRE: predkosc 9600 bodow niedostepna dla F_CPU"
+#endif
+
+static volatile uint8_t usart_1wire_busy = 0;     /**< znacznik trwajcej sekwencji */
+static volatile uint8_t usart_1wire_diag = USART1WIRE_DIAG_NO_PRESENCE; /**< wynik ostatniej sekwencji
+                                                                         RESET-PULSE-PRESENCE */
+static volatile uint8_t usart_1wire_reset = 0;    /**< bieca sekwencja to RESET-PULSE-PRESENCE */
+static const uint8_t * volatile usart_1wire_tx = NULL; /**< biecy wysyany bajt
+                                                            (NULL - szczeliny odczytu) */
+static volatile uint8_t usart_1wire_tx_byte = 0;    /**< wysyany bajt, przesuwany o kolejne bity */
+static volatile uint16_t usart_1wire_tx_slots = 0;  /**< liczba szczelin do wysania */
+static uint8_t * volatile usart_1wire_rx = NULL;    /**< miejsce zapisu odczytanego bajtu
+                                                         (NULL - odczyt pomijany) */
+static volatile uint8_t usart_1wire_rx_byte = 0;    /**< odczytywany bajt */
+static volatile uint16_t usart_1wire_rx_slots = 0;  /**< liczba szczelin do odebrania */
+static volatile uint8_t usart_1wire_error = USART1WIRE_ERR_NONE; /**< wynik ostatniej sekwencji */
+
+void USART1Wire_Init(void)
+{
+	UBRRH = (uint8_t)(USART1WIRE_UBRR_SLOT >> 8);
+	UBRRL = (uint8_t)USART1WIRE_UBRR_SLOT;
+	UCSRA = 0;
+	UCSRC = (1 << URSEL) | (1 << UCSZ1) | (1 << UCSZ0); /**< ramka 8N1 */
+	UCSRB = (1 << RXEN) | (1 << TXEN);                  /**< przerwanie RXC odblokowywane
+	                                                         na czas sekwencji */
+#if USART1WIRE_USE_FREERTOS
+	/**< utworzenie semafora oraz jego wstpne zerowanie, semafor zwalniany jest
+	     wycznie przez program obsugi przerwania ISR */
+	vSemaphoreCreateBinary(usart_1wire_ready);
+	xSemaphoreTake(usart_1wire_ready, 0);
+#endif
+}
+
+/**
+  * Wyznaczenie ramki kolejnej szczeliny do wysania
+  *
+  * Wysyany bit pobierany jest z najmodszej pozycji bajtu, po 8 szczelinach
+  * pobierany jest kolejny bajt bufora; dla szczelin odczytu zawsze 0xFF.
+  */
+static inline uint8_t USART1Wire_NextSlot(void)
+{
+	const uint8_t *tx = usart_1wire_tx;
+	uint8_t byte = usart_1wire_tx_byte;
+	uint16_t slots = --usart_1wire_tx_slots;
+	uint8_t pattern;
+
+	if (tx == NULL) return USART1WIRE_SLOT_1;
+	pattern = (byte & 0x01) ? USART1WIRE_SLOT_1 : USART1WIRE_SLOT_0;
+	if ((slots & 0x07) != 0) byte >>= 1;
+	else if (slots != 0)
+	{
+		/**< kolejny bajt bloku */
+		usart_1wire_tx = ++tx;
+		byte = *tx;
+	}
+	usart_1wire_tx_byte = byte;
+	return pattern;
+}
+
+/**
+  * Zakoczenie sekwencji, wywoywane wycznie z programu obsugi przerwania ISR
+  */
+static inline void USART1Wire_Complete(void)
+{
+	UCSRB &= ~(1 << RXCIE);
+	usart_1wire_busy = 0;
+#if USART1WIRE_USE_FREERTOS
+	signed portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+
+	xSemaphoreGiveFromISR(usart_1wire_ready, &xHigherPriorityTaskWoken);
+	/**< obudzone zadanie moe mie wyszy priorytet ni zadanie przerwane */
+	if (xHigherPriorityTaskWoken != pdFALSE)
+	{
+		taskYIELD();
+	}
+#endif
+}
+
+/**
+  * Program obsugi przerwania od odbiornika USART, wywoywany po kadej
+  * szczelinie (ramka wysana na magistral wraca do odbiornika)
+  *
+  * Nadajnik przechowuje w buforze UDR ramk kolejnej szczeliny, dziki czemu
+  * szczeliny nastpuj bez przerw; w programie obsugi przerwania do bufora
+  * wpisywana jest ramka szczeliny nastpnej.
+  */
+ISR(USART_RXC_vect)
+{
+	uint8_t status = UCSRA;	/**< znacznik FE wany wycznie przed odczytem UDR */
+	uint8_t sample = UDR;
+
+	if (usart_1wire_tx_slots != 0)
+	{
+		/**< przerwanie zgaszane jest w poowie bitu stopu, bufor nadajnika
+		     zwalniany jest dopiero po jego zakoczeniu (maks. 4,3us) */
+		while ((UCSRA & (1 << UDRE)) == 0)
+		{
+		};
+		UDR = USART1Wire_NextSlot();
+	}
+	if (usart_1wire_reset)
+	{
+		/**< impuls PRESENCE zmienia odebrany bajt sekwencji RESET; stan niski
+		     rwnie w bicie stopu (FE) lub w caej ramce to zwarcie magistrali */
+		if ((status & (1 << FE)) || (sample == 0x00)) usart_1wire_diag = USART1WIRE_DIAG_SHORT;
+		else if (sample != USART1WIRE_RESET_PATTERN) usart_1wire_diag = USART1WIRE_DIAG_OK;
+		else usart_1wire_diag = USART1WIRE_DIAG_NO_PRESENCE;
+		USART1Wire_Complete();
+		return;
+	}
+	/**< odczyt bitu, wsuwanego na najstarsz pozycj */
+	uint8_t byte = usart_1wire_rx_byte >> 1;
+	uint16_t slots = --usart_1wire_rx_slots;
+
+	if (sample == USART1WIRE_SLOT_1) byte |= 0x80;
+	usart_1wire_rx_byte = byte;
+	if ((slots & 0x07) == 0)
+	{
+		/**< zapis odczytanego bajtu do bufora */
+		uint8_t *rx = usart_1wire_rx;
+
+		if (rx != NULL)
+		{
+			*rx++ = byte;
+			usart_1wire_rx = rx;
+		}
+		if (slots == 0) USART1Wire_Complete();
+	}
+}
+
+/**
+  * Oczekiwanie na zakoczenie sekwencji rozpocztej przez USART1Wire_Start
+  *
+  * Czas oczekiwania ograniczony jest do czasu wszystkich ramek sekwencji
+  * powikszonego o USART1WIRE_TIMEOUT_MARGIN_MS. Po jego upywie przerwanie
+  * RXC jest blokowane, a stan sterownika zerowany - ramka pozostaa
+  * w nadajniku koczy si przed kolejn sekwencj, ktra zaczyna od
+  * oprnienia odbiornika.
+  *
+  * @param  frame_us czas jednej ramki [us]
+  * @param  frames liczba ramek sekwencji
+  * @return USART1WIRE_ERR_xxx
+  */
+static uint8_t USART1Wire_Wait(uint16_t frame_us, uint16_t frames)
+{
+	uint32_t timeout = (uint32_t)frames * frame_us / 1000 + 1 + USART1WIRE_TIMEOUT_MARGIN_MS; /**< [ms] */
+
+#if USART1WIRE_USE_FREERTOS
+	uint32_t ticks = timeout / portTICK_RATE_MS + 1;
+
+	if (ticks >= portMAX_DELAY) ticks = portMAX_DELAY - 1;
+	if (xSemaphoreTake(usart_1wire_ready, (portTickType)ticks) == pdTRUE) return usart_1wire_error;
+#else
+	timeout *= 100;
+	while (usart_1wire_busy)
+	{
+		if (timeout-- == 0) break;
+		_delay_us(10);
+	}
+	if (!usart_1wire_busy) return usart_1wire_error;
+#endif
+	/**< przekroczony czas - zablokowanie przerwania i zerowanie stanu sterownika */
+	uint8_t sreg = SREG;
+
+	cli();
+	UCSRB &= ~(1 << RXCIE);
+	SREG = sreg;
+	usart_1wire_reset = 0;
+	usart_1wire_tx = NULL;
+	usart_1wire_tx_slots = 0;
+	usart_1wire_rx = NULL;
+	usart_1wire_rx_slots = 0;
+	usart_1wire_busy = 0;
+	usart_1wire_error = USART1WIRE_ERR_TIMEOUT;
+#if USART1WIRE_USE_FREERTOS
+	/**< semafor mg zosta zwolniony po upywie czasu, przed zablokowaniem przerwania */
+	xSemaphoreTake(usart_1wire_ready, 0);
+#endif
+	return usart_1wire_error;
+}
+
+/**
+  * Rozpoczcie sekwencji opisanej przez zmienne usart_1wire_xxx i oczekiwanie
+  * na jej zakoczenie
+  *
+  * Do nadajnika wpisywane s dwie pierwsze ramki (rejestr przesuwajcy i bufor),
+  * kolejne wpisywane s w programie obsugi przerwania ISR.
+  *
+  * @param  frame ramka pierwszej szczeliny
+  * @param  frame_us czas jednej ramki [us] (wyznaczenie czasu oczekiwania)
+  * @return USART1WIRE_ERR_xxx
+  */
+static uint8_t USART1Wire_Start(uint8_t frame, uint16_t frame_us)
+{
+	uint16_t frames = usart_1wire_tx_slots + 1;
+
+	usart_1wire_error = USART1WIRE_ERR_NONE;
+	usart_1wire_busy = 1;
+	/**< usunicie z odbiornika ewentualnych zakce odebranych poza sekwencj */
+	while (UCSRA & (1 << RXC)) (void)UDR;
+	UCSRB |= (1 << RXCIE);
+	UDR = frame;
+	if (usart_1wire_tx_slots != 0)
+	{
+		/**< pierwsza ramka przechodzi do rejestru przesuwajcego po jednym takcie */
+		while ((UCSRA & (1 << UDRE)) == 0)
+		{
+		};
+		UDR = USART1Wire_NextSlot();
+	}
+	return USART1Wire_Wait(frame_us, frames);
+}
+
+/**
+  * Sekwencja szczelin zapisu (tx rne od NULL) lub odczytu
+  */
+static void USART1Wire_Slots(const uint8_t *tx, uint8_t *rx, uint16_t slots)
+{
+	usart_1wire_reset = 0;
+	usart_1wire_tx = tx;
+	usart_1wire_tx_byte = (tx != NULL) ? *tx : USART1WIRE_SLOT_1;
+	usart_1wire_tx_slots = slots;
+	usart_1wire_rx = rx;
+	usart_1wire_rx_slots = slots;
+	USART1Wire_Start(USART1Wire_NextSlot(), USART1WIRE_FRAME_US(USART1WIRE_BAUD_SLOT));
+}
+
+uint8_t USART1Wire_ResetDiagnostic(void)
+{
+	/**< zmiana prdkoci wycznie przy pustym nadajniku (po zakoczeniu sekwencji) */
+	UBRRH = (uint8_t)(USART1WIRE_UBRR_RESET >> 8);
+	UBRRL = (uint8_t)USART1WIRE_UBRR_RESET;
+	/**< pojedyncza ramka 0xF0 */
+	usart_1wire_reset = 1;
+	usart_1wire_tx_slots = 0;
+	usart_1wire_diag = USART1WIRE_DIAG_NO_PRESENCE;
+	if (USART1Wire_Start(USART1WIRE_RESET_PATTERN,
+	                     USART1WIRE_FRAME_US(USART1WIRE_BAUD_RESET)) != USART1WIRE_ERR_NONE)
+		usart_1wire_diag = USART1WIRE_DIAG_FAULT;
+	UBRRH = (uint8_t)(USART1WIRE_UBRR_SLOT >> 8);
+	UBRRL = (uint8_t)USART1WIRE_UBRR_SLOT;
+	return usart_1wire_diag;
+}
+
+uint8_t USART1Wire_ResetPresence(void)
+{
+	return (USART1Wire_ResetDiagnostic() == USART1WIRE_DIAG_OK) ? 1 : USART1WIRE_NO_PRESENCE;
+}
+
+void USART1Wire_Write(uint8_t byte)
+{
+	USART1Wire_WriteBlock(&byte, 1);
+}
+
+uint8_t USART1Wire_Read(void)
+{
+	uint8_t byte = 0;
+
+	USART1Wire_ReadBlock(&byte, 1);
+	return byte;
+}
+
+void USART1Wire_WriteBlock(const uint8_t *buffer, uint16_t length)
+{
+	if (length == 0) return;
+	USART1Wire_Slots(buffer, NULL, length * 8);
+}
+
+void USART1Wire_ReadBlock(uint8_t *buffer, uint16_t length)
+{
+	if (length == 0) return;
+	USART1Wire_Slots(NULL, buffer, length * 8);
+}
+
+void USART1Wire_WriteBit(uint8_t bit)
+{
+	uint8_t byte = (bit != 0);
+
+	USART1Wire_Slots(&byte, NULL, 1);
+}
+
+uint8_t USART1Wire_ReadBit(void)
+{
+	uint8_t byte = 0;
+
+	/**< odczytany bit zapisywany jest na najstarszej pozycji; po przekroczeniu
+	     czasu zwracane jest 0 */
+	USART1Wire_Slots(NULL, &byte, 1);
+	return byte >> 7;
+}
+
+uint8_t USART1Wire_GetError(void)
+{
+	return usart_1wire_error;
+}
@@ -0,0 +1,210 @@
+/** @file usart1wire.h
+  *
+  * @author B.W.
+  *
+  * Biblioteka do obsugi interfejsu 1-Wire z wykorzystaniem sprztowego
+  * interfejsu USART mikrokontrolera (alternatywa dla spi1wire.h, zwalnia
+  * interfejs SPI dla innych ukadw)
+  *
+  * Jedna ramka USART (bit startu, 8 bitw danych, bit stopu) odpowiada jednej
+  * szczelinie czasowej 1-Wire:
+  * - sekwencja RESET-PULSE-PRESENCE - 9600 bodw, bajt 0xF0 (520us stanu niskiego),
+  *   impuls PRESENCE zmienia odebrany bajt,
+  * - szczeliny zapisu i odczytu - 115200 bodw, bajt 0x00 (zapis 0, 78us) lub
+  *   0xFF (zapis 1 i odczyt, 8,7us); odczytany bajt 0xFF oznacza bit o wartoci 1.
+  * Wyprowadzenie TXD steruje magistral przez ukad z otwartym drenem (lub diod),
+  * wyprowadzenie RXD doczone jest bezporednio do magistrali.
+  *
+  */
+
+#ifndef USART1WIRE_H_
+#define USART1WIRE_H_
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+/**
+  * @def USART1WIRE_USE_FREERTOS
+  *
+  * Sposb oczekiwania na zakoczenie sekwencji interfejsu 1-Wire (jak
+  * SPI1WIRE_USE_FREERTOS):
+  * - 1 - zadanie wywoujce funkcj biblioteki jest blokowane na semaforze
+  *       systemu FreeRTOS, zwalnianym w programie obsugi przerwania ISR,
+  * - 0 - aktywne oczekiwanie w ptli (wersja bez systemu operacyjnego).
+  */
+#ifndef USART1WIRE_USE_FREERTOS
+#define USART1WIRE_USE_FREERTOS		1
+#endif
+
+/**
+  * @def prdkoci transmisji interfejsu USART [bod]
+  */
+#define USART1WIRE_BAUD_RESET		9600UL		/**< sekwencja RESET-PULSE-PRESENCE */
+#define USART1WIRE_BAUD_SLOT		115200UL	/**< szczeliny zapisu i odczytu */
+
+/**
+  * @def wzorce ramek USART
+  */
+#define USART1WIRE_RESET_PATTERN	0xF0	/**< sekwencja RESET, odebrana bez zmian
+                                             oznacza brak impulsu PRESENCE */
+#define USART1WIRE_SLOT_0			0x00	/**< szczelina zapisu 0 */
+#define USART1WIRE_SLOT_1			0xFF	/**< szczelina zapisu 1 i odczytu */
+
+#define USART1WIRE_NO_PRESENCE		0		/**< oznacza brak odpowiedzi ukadu SLAVE */
+
+/**
+  * @def wynik sekwencji RESET (USART1Wire_ResetDiagnostic), wartoci zgodne
+  *      z SPI1WIRE_DIAG_xxx biblioteki spi1wire.h
+  */
+#define USART1WIRE_DIAG_OK			0		/**< impuls PRESENCE, ukady odpowiadaj */
+#define USART1WIRE_DIAG_NO_PRESENCE	2		/**< brak impulsu PRESENCE (odebrany bajt 0xF0) */
+#define USART1WIRE_DIAG_SHORT		3		/**< stan niski przez ca ramk RESET (odebrany
+                                                 bajt 0x00 lub bd ramki FE - brak bitu
+                                                 stopu), zwarcie magistrali do masy */
+#define USART1WIRE_DIAG_FAULT		5		/**< bd sterownika (USART1Wire_GetError) */
+
+/**
+  * @def kody bdw ostatniej sekwencji (USART1Wire_GetError), wartoci zgodne
+  *      z SPI1WIRE_ERR_xxx biblioteki spi1wire.h
+  */
+#define USART1WIRE_ERR_NONE			0		/**< sekwencja zakoczona poprawnie */
+#define USART1WIRE_ERR_TIMEOUT		1		/**< sekwencja nie zakoczya si w wyznaczonym
+                                                 czasie (np. magistrala w stanie niskim po
+                                                 ramce - odbiornik nie wykrywa kolejnego bitu
+                                                 startu i przerwanie RXC nie jest zgaszane) */
+
+/**
+  * @def USART1WIRE_TIMEOUT_MARGIN_MS
+  *
+  * Zapas czasu oczekiwania na zakoczenie sekwencji [ms], dodawany do czasu
+  * wszystkich jej ramek. Po jego upywie przerwanie RXC jest blokowane,
+  * a funkcja zwraca bd USART1WIRE_ERR_TIMEOUT - uszkodzenie kosztuje
+  * ograniczony, znany czas (jak SPI1WIRE_TIMEOUT_MARGIN_MS).
+  */
+#ifndef USART1WIRE_TIMEOUT_MARGIN_MS
+#define USART1WIRE_TIMEOUT_MARGIN_MS	10
+#endif
+
+/**
+  * Funkcja inicjalizujca interfejs USART mikrokontrolera
+  *
+  * Wybierany jest format ramki 8N1 oraz prdko szczelin czasowych.
+  * Dodatkowo wymagane jest odblokowanie przerwa.
+  * W trybie USART1WIRE_USE_FREERTOS tworzony jest semafor sygnalizujcy
+  * zakoczenie sekwencji, dlatego funkcj naley wywoa przed
+  * uruchomieniem planisty.
+  *
+  * @param  brak
+  * @return brak
+  *
+  */
+void USART1Wire_Init(void);
+
+/**
+  * Funkcja wykonujca sekwencj RESET-PULSE-PRESENCE
+  *
+  * Wymagana jest wczeniejsze zainicjowanie interfejsu USART.
+  *
+  * @param  brak
+  * @return 0 - brak odpowiedzi ukadw SLAVE (USART1WIRE_NO_PRESENCE) lub
+  *         bd sterownika, w przeciwnym razie zwracana jest warto rna od zera
+  *
+  */
+uint8_t USART1Wire_ResetPresence(void);
+
+/**
+  * Funkcja wykonujca sekwencj RESET-PULSE-PRESENCE z rozrnieniem
+  * przyczyny braku odpowiedzi
+  *
+  * Zwarta magistrala zeruje ca odebran ramk cznie z bitem stopu,
+  * co odrnia j od impulsu PRESENCE (zmienione wycznie bity danych).
+  * USART1Wire_ResetPresence zwraca dla niej USART1WIRE_NO_PRESENCE.
+  *
+  * @param  brak
+  * @return USART1WIRE_DIAG_xxx; bd sterownika (USART1Wire_GetError) zwraca
+  *         USART1WIRE_DIAG_FAULT
+  *
+  */
+uint8_t USART1Wire_ResetDiagnostic(void);
+
+/**
+  * Funkcja wysyajca bajt danych na magistral 1-Wire
+  *
+  * Wymagana jest wczeniejsze zainicjowanie interfejsu USART.
+  *
+  * @param  byte wysyana warto
+  * @return brak
+  *
+  */
+void USART1Wire_Write(uint8_t byte);
+
+/**
+  * Funkcja pobierajca bajt danych z magistrali 1-Wire
+  *
+  * Wymagana jest wczeniejsze zainicjowanie interfejsu USART.
+  *
+  * @param  brak
+  * @return odczytany bajt danych z magistrali 1-Wire
+  *
+  */
+uint8_t USART1Wire_Read(void);
+
+/**
+  * Funkcja wysyajca blok danych na magistral 1-Wire
+  *
+  * Cay blok przesyany jest w programie obsugi przerwania ISR, bez udziau
+  * zadania wywoujcego pomidzy kolejnymi bajtami.
+  *
+  * @param  [in] buffer wysyane dane
+  * @param  length liczba wysyanych bajtw
+  * @return brak
+  *
+  */
+void USART1Wire_WriteBlock(const uint8_t *buffer, uint16_t length);
+
+/**
+  * Funkcja pobierajca blok danych z magistrali 1-Wire
+  *
+  * Cay blok odczytywany jest w programie obsugi przerwania ISR, bez udziau
+  * zadania wywoujcego pomidzy kolejnymi bajtami.
+  *
+  * @param  [out] buffer bufor na odczytane dane
+  * @param  length liczba odczytywanych bajtw
+  * @return brak
+  *
+  */
+void USART1Wire_ReadBlock(uint8_t *buffer, uint16_t length);
+
+/**
+  * Funkcja wysyajca pojedynczy bit na magistral 1-Wire
+  *
+  * @param  bit wysyana warto (0 lub rna od zera)
+  * @return brak
+  *
+  */
+void USART1Wire_WriteBit(uint8_t bit);
+
+/**
+  * Funkcja pobierajca pojedynczy bit z magistrali 1-Wire
+  *
+  * @param  brak
+  * @return odczytany bit (0 lub 1)
+  *
+  */
+uint8_t USART1Wire_ReadBit(void);
+
+/**
+  * Funkcja zwracajca kod bdu ostatniej sekwencji
+  *
+  * Wszystkie funkcje generujce sekwencje na magistrali oczekuj na ich
+  * zakoczenie przez ograniczony czas; funkcje bez wartoci zwracanej
+  * (np. USART1Wire_WriteBlock) sygnalizuj bd wycznie tym kodem,
+  * odczytane dane s wwczas niekompletne.
+  *
+  * @param  brak
+  * @return USART1WIRE_ERR_xxx
+  *
+  */
+uint8_t USART1Wire_GetError(void);
+
+#endif //USART1WIRE_H_
@@ -0,0 +1,9 @@
+#ifndef FRACTION_H
+#define FRACTION_H
+
+#include <avr/io.h>
+
+// wyswietlenie czesci ulamkowej temperatury (4 najmlodsze bity, krok 0.0625)
+void LCDWriteFraction(unsigned char fract);
+
+#endif //FRACTION_H
@@ -0,0 +1,92 @@
+/*
+	Uklad:
+		* LCD: PC0-SDA; PC1-SDL
+		* DS18B20: magistrala 1Wire, implementacja wybierana w pliku main.h
+		           (ONEWIRE_BACKEND, opis w pliku onewire.h)
+
+	Test application:
+		* Bare-Metal embedded system
+
+ */
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#include "main.h"
+#include <util/delay.h>
+#include "pcf8574.h"
+#include "twi.h"
+#include "lcd.h"
+#include "onewire.h"
+#include "ds18b20.h"
+#include "fraction.h"
+
+void main(void)
+{
+	TWI_init(); // wyswietlacz z interfejsem TWI, inicjalizacja TWI
+	LCDInit();  // Inicjalizacja wyswietlacza
+	LCDGoTo(0); // Pisz od pozycji 0
+
+	OneWire_Init(); // inicjalizacja wybranej implementacji interfejsu 1Wire
+	// enable interrupts
+	sei();
+
+	// test cyklicznego pomiaru temperatury
+	uint8_t tempH, tempL;
+
+	for(;;)
+	{
+	  if (OneWire_ResetPresence() != ONEWIRE_NO_PRESENCE)
+	    {
+		  // uklad obecny na magistrali, inicjalizacja konwersji temperatury
+		  OneWire_Write(cmd_DS18x20_SkipROM);
+		  OneWire_Write(cmd_DS18x20_ConvertT);
+#if DS18B20_POLL_MS
+		  // odczyt temperatury tuz po zakonczeniu konwersji
+		  for (uint16_t wait = 0; (wait < 750) && (OneWire_Read() == 0); wait += DS18B20_POLL_MS)
+			_delay_ms(DS18B20_POLL_MS);
+#else
+		  _delay_ms(750);
+#endif
+
+		  // odczyt temperatury
+		  OneWire_ResetPresence();
+		  OneWire_Write(cmd_DS18x20_SkipROM);
+		  OneWire_Write(cmd_DS18x20_ReadScratchpad);
+		  tempL = OneWire_Read();
+		  tempH = OneWire_Read();
+
+		  // wyniku pomiaru temperatury
+		  uint16_t temp = (tempH << 8) + tempL;
+
+		  LCDClear();
+		  LCDGoTo(0);
+
+          if ((temp & 0x8000) != 0)
+		  {
+			LCDPutChar('-');
+			temp = ~temp + 1;
+		  }
+		  else
+		  {
+			LCDPutChar('+');
+		  }
+
+		  uint8_t temp_t = temp >> 4;
+
+		  LCDPutChar((temp_t / 100) + '0');
+		  LCDPutChar(((temp_t % 100) / 10) + '0');
+		  LCDPutChar((temp_t % 10) + '0');
+
+		  LCDWriteFraction(temp & 0x0F);
+	    }
+	  else
+	    {
+		  // uklad nieobecny
+		  LCDClear();
+		  LCDGoTo(0);
+		  LCDPutsCode("No DS18B20 found!");
+		  _delay_ms(1000);
+	    }
+	}//for
+}
@@ -9,4 +9,21 @@
 #define LCD_BKLight		3
 #define LCD_DATA        4
 
+// implementacja interfejsu 1Wire (onewire.h): ONEWIRE_BACKEND_TIMER0 (0),
+// ONEWIRE_BACKEND_SPI (1), ONEWIRE_BACKEND_SPI_ISR (2)
+#define ONEWIRE_BACKEND	2
+
+// wyprowadzenie magistrali 1Wire dla ONEWIRE_BACKEND_TIMER0 (adres PINx i numer bitu)
+#define PORT_1Wire PINB
+#define PIN_1Wire  PINB0
+// magistrale trybu rownoleglego ONEWIRE_BACKEND_TIMER0 (wyprowadzenia portu
+// PORT_1Wire): PB0-PB3, PB4-PB7 to wyprowadzenia interfejsu SPI
+#define BUS_1Wire_MASK 0x0F
+
+// oczekiwanie na koniec konwersji DS18B20: odczyt bajtu (8 szczelin) co
+// DS18B20_POLL_MS [ms], uklad zasilany zewnetrznie odpowiada 0 do zakonczenia
+// konwersji, najwyzej 750ms; 0 - stale opoznienie 750ms (wymagane przy
+// zasilaniu pasozytniczym)
+#define DS18B20_POLL_MS 10
+
 #endif//MAIN_H
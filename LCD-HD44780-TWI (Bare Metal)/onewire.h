@@ -0,0 +1,64 @@
+/*
+    Wspolny interfejs magistrali 1Wire dla aplikacji bez systemu operacyjnego
+
+    * wybor implementacji (backendu) w czasie kompilacji - ONEWIRE_BACKEND
+      w pliku main.h, kompilowany jest wylacznie wybrany plik onewire_xxx.c,
+      funkcje wywolywane sa bezposrednio (bez wskaznikow do funkcji)
+    * ONEWIRE_BACKEND_TIMER0  - programowe generowanie przebiegow, opoznienia
+                                odmierzane licznikiem T0 (dowolne wyprowadzenie,
+                                PORT_1Wire/PIN_1Wire w pliku main.h)
+    * ONEWIRE_BACKEND_SPI     - interfejs SPI, oczekiwanie na kazdy bit
+                                (MOSI/MISO polaczone z magistrala)
+    * ONEWIRE_BACKEND_SPI_ISR - interfejs SPI, bajt przesylany w przerwaniu
+    * backendy wykorzystujace przerwania wymagaja wywolania sei() po
+      OneWire_Init()
+
+ */
+
+#ifndef ONEWIRE_H
+#define ONEWIRE_H
+
+#include "main.h"
+#include <avr/io.h>
+
+#define ONEWIRE_BACKEND_TIMER0		0
+#define ONEWIRE_BACKEND_SPI			1
+#define ONEWIRE_BACKEND_SPI_ISR		2
+
+#ifndef ONEWIRE_BACKEND
+#define ONEWIRE_BACKEND		ONEWIRE_BACKEND_SPI_ISR
+#endif
+
+#if (ONEWIRE_BACKEND != ONEWIRE_BACKEND_TIMER0) && \
+    (ONEWIRE_BACKEND != ONEWIRE_BACKEND_SPI) &&    \
+    (ONEWIRE_BACKEND != ONEWIRE_BACKEND_SPI_ISR)
+#error "ONEWIRE_BACKEND: nieznana implementacja interfejsu 1Wire"
+#endif
+
+#define ONEWIRE_NO_PRESENCE		0
+
+// inicjalizacja ukladow peryferyjnych wybranej implementacji
+void OneWire_Init(void);
+// sekwencja RESET-PULSE-PRESENCE, ONEWIRE_NO_PRESENCE - brak ukladu na magistrali
+uint8_t OneWire_ResetPresence(void);
+// zapis bajtu (od najmlodszego bitu)
+void OneWire_Write(uint8_t byte);
+// odczyt bajtu (od najmlodszego bitu)
+uint8_t OneWire_Read(void);
+
+#if ONEWIRE_BACKEND == ONEWIRE_BACKEND_TIMER0
+//
+// Tryb rownolegly (tylko ONEWIRE_BACKEND_TIMER0): do 8 niezaleznych magistral
+// na wyprowadzeniach BUS_1Wire_MASK portu PORT_1Wire (main.h), bit maski
+// i indeks tablicy odpowiadaja numerowi wyprowadzenia
+//
+// sekwencja RESET-PULSE-PRESENCE na wszystkich magistralach, maska magistral
+// z ukladami obecnymi
+uint8_t OneWire_ResetPresenceParallel(void);
+// zapis bajtow bytes[0..7] na magistrale wskazane maska bus
+void OneWire_WriteParallel(uint8_t bus, const uint8_t *bytes);
+// odczyt bajtow bytes[0..7] z magistral wskazanych maska bus (pozostale 0)
+void OneWire_ReadParallel(uint8_t bus, uint8_t *bytes);
+#endif
+
+#endif //ONEWIRE_H
@@ -0,0 +1,85 @@
+/*
+    Implementacja interfejsu 1Wire: interfejs SPI, aktywne oczekiwanie
+    na zakonczenie kazdego bitu (jeden bajt SPI - jedna szczelina 1Wire)
+
+ */
+
+#include "onewire.h"
+
+#if ONEWIRE_BACKEND == ONEWIRE_BACKEND_SPI
+
+#include <avr/io.h>
+#include "onewire_spi.h"
+
+void OneWire_Init(void)
+{
+	DDRB |= (1 << MOSI) | (1 << SCK);// | (1 << SS); // w MASTER SS musi byc jako wyjscie lub wejscie ale w stanie wysokim
+	PORTB |= (1 << SS);
+	SPCR = (1 << SPE) | (1 << MSTR) | ONEWIRE_SPI_SPCR; // dzielnik wyznaczony dla F_CPU (onewire_spi.h)
+	SPSR = ONEWIRE_SPI_SPSR;
+}
+
+uint8_t OneWire_ResetPresence(void)
+{
+	// reset
+	for (uint8_t i = 0; i < ONEWIRE_SPI_RESET_BYTES; i++)
+	{
+		SPDR = ONEWIRE_SPI_PATTERN_0;
+		while(!(SPSR & (1<<SPIF)))
+		;
+	}
+		
+	// wait for presence
+	uint8_t presence = 0;
+	for (uint8_t i = 0; i < ONEWIRE_SPI_RSTH_BYTES; i++)
+	{
+		SPDR = 0xFF;
+		while(!(SPSR & (1<<SPIF)))
+		;
+		if (SPDR == 0) presence++;
+	}
+
+	return presence;
+}
+
+static void OneWire_WriteBit(uint8_t bit)
+{
+	if (bit == 0)
+		SPDR = ONEWIRE_SPI_PATTERN_0;
+	else
+		SPDR = ONEWIRE_SPI_PATTERN_1;
+	
+	while(!(SPSR & (1<<SPIF)))
+		;
+}
+
+static uint8_t OneWire_ReadBit(void)
+{
+	SPDR = ONEWIRE_SPI_PATTERN_1;
+	
+	while(!(SPSR & (1<<SPIF)))
+	;
+
+	if ((SPDR & ONEWIRE_SPI_READ_MASK) == ONEWIRE_SPI_READ_MASK)
+		return 1;
+	else
+		return 0;
+}
+
+void OneWire_Write(uint8_t byte)
+{
+	for (uint8_t i = 0; i < 8; i++)
+		OneWire_WriteBit(byte & (1 << i));
+}
+
+uint8_t OneWire_Read(void)
+{
+	uint8_t tmp = 0;
+	
+	for (uint8_t i = 0; i < 8; i++)
+		if (OneWire_ReadBit() != 0) tmp |= (1 << i);
+		
+	return tmp;
+}
+
+#endif //ONEWIRE_BACKEND_SPI
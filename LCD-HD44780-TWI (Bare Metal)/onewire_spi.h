@@ -0,0 +1,122 @@
+/*
+    Parametry sekwencji 1Wire backendow SPI (ONEWIRE_BACKEND_SPI,
+    ONEWIRE_BACKEND_SPI_ISR), wyznaczane w czasie kompilacji na podstawie F_CPU
+
+    * jeden bajt SPI - jedna szczelina 1Wire (predkosc standardowa), wybierany
+      jest najmniejszy dzielnik zegara SPI, dla ktorego bajt 0x00 trwa co
+      najmniej 60us (tLOW0 min)
+    * dla 14,7456MHz: dzielnik 128 (bit 8,68us), wzorzec zapisu 1 i odczytu
+      0x7F, maska odczytu 0x3F, RESET 8 bajtow 0x00, obserwacja magistrali
+      4 bajty 0xFF
+    * brak dzielnika spelniajacego wymagania przerywa kompilacje
+
+ */
+
+#ifndef ONEWIRE_SPI_H
+#define ONEWIRE_SPI_H
+
+#include "main.h"
+#include <avr/io.h>
+
+#ifndef F_CPU
+#error "F_CPU nie zostala zdefiniowana"
+#endif
+
+// definicje wyprowadzen interfejsu SPI
+					// MASTER       SLAVE
+#define MOSI PB5	// out(user)    in
+#define MISO PB6	// in           out(user)
+#define SCK  PB7    // out(user)    in
+#define SS   PB4    // (user)       in
+
+//
+// Wymagania czasowe interfejsu 1Wire [ns]
+//
+#define ONEWIRE_SPI_SLOT_MIN_NS		60000UL		// tSLOT, tLOW0 min (bajt 0x00)
+#define ONEWIRE_SPI_SLOT_MAX_NS		120000UL	// tSLOT, tLOW0 max
+#define ONEWIRE_SPI_LOW1_MIN_NS		1000UL		// tLOW1, tRL min
+#define ONEWIRE_SPI_LOW1_MAX_NS		15000UL		// tLOW1 max
+#define ONEWIRE_SPI_RISE_NS			5000UL		// pominiecie probek tuz po zwolnieniu magistrali
+#define ONEWIRE_SPI_RESET_NS		500000UL	// tRSTL (min 480us) z zapasem
+#define ONEWIRE_SPI_RESET_MAX_NS	960000UL	// tRSTL max
+#define ONEWIRE_SPI_RSTH_NS			240000UL	// obserwacja magistrali po RESET (tPDL max)
+
+// czas przeslania bitu SPI [ns] dla dzielnika div
+#define onewire_spi_bit_ns(div)		((div) * 1000000UL / (F_CPU / 1000UL))
+// probka bitu i bajtu SPI (wysylanego od najstarszego) w chwili (i + 0,5) * tb
+// w przedziale <from, to>
+#define onewire_spi_sample(i, tb, from, to)	\
+	((((2 * (i) + 1) * (tb) / 2) >= (from)) && (((2 * (i) + 1) * (tb) / 2) <= (to)) ? (0x80 >> (i)) : 0)
+#define onewire_spi_sample_mask(tb, from, to)	\
+	(onewire_spi_sample(0, tb, from, to) | onewire_spi_sample(1, tb, from, to) |	\
+	 onewire_spi_sample(2, tb, from, to) | onewire_spi_sample(3, tb, from, to) |	\
+	 onewire_spi_sample(4, tb, from, to) | onewire_spi_sample(5, tb, from, to) |	\
+	 onewire_spi_sample(6, tb, from, to) | onewire_spi_sample(7, tb, from, to))
+
+//
+// Najmniejszy dzielnik, dla ktorego bajt 0x00 spelnia tLOW0 min
+//
+#if   (8 * onewire_spi_bit_ns(2)) >= ONEWIRE_SPI_SLOT_MIN_NS
+#define ONEWIRE_SPI_DIV		2
+#elif (8 * onewire_spi_bit_ns(4)) >= ONEWIRE_SPI_SLOT_MIN_NS
+#define ONEWIRE_SPI_DIV		4
+#elif (8 * onewire_spi_bit_ns(8)) >= ONEWIRE_SPI_SLOT_MIN_NS
+#define ONEWIRE_SPI_DIV		8
+#elif (8 * onewire_spi_bit_ns(16)) >= ONEWIRE_SPI_SLOT_MIN_NS
+#define ONEWIRE_SPI_DIV		16
+#elif (8 * onewire_spi_bit_ns(32)) >= ONEWIRE_SPI_SLOT_MIN_NS
+#define ONEWIRE_SPI_DIV		32
+#elif (8 * onewire_spi_bit_ns(64)) >= ONEWIRE_SPI_SLOT_MIN_NS
+#define ONEWIRE_SPI_DIV		64
+#elif (8 * onewire_spi_bit_ns(128)) >= ONEWIRE_SPI_SLOT_MIN_NS
+#define ONEWIRE_SPI_DIV		128
+#else
+#error "F_CPU zbyt duza: szczelina 1Wire (8 bitow SPI) krotsza niz 60us przy dzielniku 128"
+#define ONEWIRE_SPI_DIV		128
+#endif
+
+#define ONEWIRE_SPI_BIT_NS		onewire_spi_bit_ns(ONEWIRE_SPI_DIV)
+
+// bity SPR1:SPR0 rejestru SPCR oraz SPI2X rejestru SPSR
+#define ONEWIRE_SPI_SPCR	\
+	(((ONEWIRE_SPI_DIV == 8) || (ONEWIRE_SPI_DIV == 16)) ? (1 << SPR0) :	\
+	 ((ONEWIRE_SPI_DIV == 32) || (ONEWIRE_SPI_DIV == 64)) ? (1 << SPR1) :	\
+	 (ONEWIRE_SPI_DIV == 128) ? ((1 << SPR1) | (1 << SPR0)) : 0)
+#define ONEWIRE_SPI_SPSR	\
+	(((ONEWIRE_SPI_DIV == 2) || (ONEWIRE_SPI_DIV == 8) || (ONEWIRE_SPI_DIV == 32)) ? (1 << SPI2X) : 0)
+
+// liczba bitow o stanie niskim rozpoczynajacych szczeline zapisu 1 i odczytu
+#define ONEWIRE_SPI_LOW1_BITS	((ONEWIRE_SPI_LOW1_MIN_NS + ONEWIRE_SPI_BIT_NS - 1) / ONEWIRE_SPI_BIT_NS)
+
+#define ONEWIRE_SPI_PATTERN_0	0x00							// zapis 0 (caly bajt)
+#define ONEWIRE_SPI_PATTERN_1	(0xFF >> ONEWIRE_SPI_LOW1_BITS)	// zapis 1 i odczyt
+// maska probek szczeliny odczytu, wszystkie musza miec stan wysoki dla bitu 1
+#define ONEWIRE_SPI_READ_MASK	onewire_spi_sample_mask(ONEWIRE_SPI_BIT_NS,	\
+									ONEWIRE_SPI_LOW1_BITS * ONEWIRE_SPI_BIT_NS + ONEWIRE_SPI_RISE_NS,	\
+									ONEWIRE_SPI_SLOT_MAX_NS)
+
+// liczba bajtow 0x00 sekwencji RESET oraz 0xFF obserwacji magistrali
+#define ONEWIRE_SPI_RESET_BYTES	((ONEWIRE_SPI_RESET_NS + 8 * ONEWIRE_SPI_BIT_NS - 1) / (8 * ONEWIRE_SPI_BIT_NS))
+#define ONEWIRE_SPI_RSTH_BYTES	((ONEWIRE_SPI_RSTH_NS + 8 * ONEWIRE_SPI_BIT_NS - 1) / (8 * ONEWIRE_SPI_BIT_NS))
+
+//
+// Kontrola wymagan czasowych dla wybranego dzielnika
+//
+#if (8 * ONEWIRE_SPI_BIT_NS) > ONEWIRE_SPI_SLOT_MAX_NS
+#error "F_CPU: szczelina 1Wire dluzsza niz 120us"
+#endif
+#if (ONEWIRE_SPI_LOW1_BITS * ONEWIRE_SPI_BIT_NS) > ONEWIRE_SPI_LOW1_MAX_NS
+#error "F_CPU: impuls zapisu 1 dluzszy niz 15us"
+#endif
+#if ONEWIRE_SPI_READ_MASK == 0
+#error "F_CPU: brak probki odczytu w szczelinie"
+#endif
+#if (ONEWIRE_SPI_RESET_BYTES * 8 * ONEWIRE_SPI_BIT_NS) > ONEWIRE_SPI_RESET_MAX_NS
+#error "F_CPU: impuls RESET dluzszy niz 960us"
+#endif
+// pole LLLLL rozkazu ONEWIRE_BACKEND_SPI_ISR
+#if (ONEWIRE_SPI_RESET_BYTES + ONEWIRE_SPI_RSTH_BYTES) > 32
+#error "F_CPU: sekwencja RESET-PULSE-PRESENCE przekracza 32 bajty"
+#endif
+
+#endif //ONEWIRE_SPI_H
@@ -0,0 +1,160 @@
+/*
+    Implementacja interfejsu 1Wire: interfejs SPI, bajt 1Wire (8 szczelin)
+    lub sekwencja RESET przesylane w programie obslugi przerwania SPI
+
+ */
+
+#include "onewire.h"
+
+#if ONEWIRE_BACKEND == ONEWIRE_BACKEND_SPI_ISR
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "onewire_spi.h"
+
+void OneWire_Init(void)
+{
+	DDRB |= (1 << MOSI) | (1 << SCK);// | (1 << SS); // w MASTER SS musi byc jako wyjscie lub wejscie ale w stanie wysokim
+	PORTB |= (1 << SS);
+	SPCR = (1 << SPE) | (1 << MSTR) | ONEWIRE_SPI_SPCR; // dzielnik wyznaczony dla F_CPU (onewire_spi.h)
+	SPSR = ONEWIRE_SPI_SPSR;
+}
+
+static volatile uint8_t spi_1wire_command = 0;
+static volatile uint8_t spi_1wire_data = 0;
+
+/*
+    Kodowanie rozkazu
+	
+	|R|C|C|L|L|L|L|L|
+	
+	R     - znacznik zakonczenia wykonywania rozkazu (ready)
+    CC    - typ rozkazu (00 - reset-pulse; 01 - read byte; 10 - write byte)
+	LLLLL - odliczanie przesylanych bajtow
+*/
+
+#define SPI_1WIRE_CMD_READY			0x80
+#define SPI_1WIRE_CMD_READY_MASK	0x7F
+	
+#define SPI_1WIRE_CMD				0x60
+#define SPI_1WIRE_CMD_MASK			0x9F
+
+#define SPI_1WIRE_CMD_RESETPULSE	0x00
+#define SPI_1WIRE_CMD_READ			0x20
+#define SPI_1WIRE_CMD_WRITE			0x40
+
+#define SPI_1WIRE_CMD_CNT_MASK		0x1F
+
+// ostatni krok sekwencji RESET-PULSE-PRESENCE: ONEWIRE_SPI_RESET_BYTES bajtow 0x00
+// oraz ONEWIRE_SPI_RSTH_BYTES bajtow 0xFF (dla 14,7456MHz 8 + 4, kroki 0x00-0x0B)
+#define SPI_1WIRE_RESET_LAST		(ONEWIRE_SPI_RESET_BYTES - 1)
+#define SPI_1WIRE_PULSE_LAST		(ONEWIRE_SPI_RESET_BYTES + ONEWIRE_SPI_RSTH_BYTES - 1)
+
+ISR(SPI_STC_vect)
+{
+	switch(spi_1wire_command & SPI_1WIRE_CMD_READY_MASK)
+	{
+		// RESET-PULSE COMMAND
+		case 0x00 ... (SPI_1WIRE_RESET_LAST - 1):  // reset sequence
+					SPDR = ONEWIRE_SPI_PATTERN_0;
+					spi_1wire_command++;
+					break;
+		case SPI_1WIRE_RESET_LAST:
+					SPDR = 0xFF;
+					spi_1wire_command++;
+					spi_1wire_data = 0;
+					break;
+		case (SPI_1WIRE_RESET_LAST + 1) ... (SPI_1WIRE_PULSE_LAST - 1):  // pulse sequence
+					if (SPDR == 0) spi_1wire_data++;
+					SPDR = 0xFF;
+					spi_1wire_command++;
+					break;
+		case SPI_1WIRE_PULSE_LAST:
+					if (SPDR == 0) spi_1wire_data++;
+					spi_1wire_command |= SPI_1WIRE_CMD_READY;
+					SPCR &= ~(1 << SPIE);
+					break;
+					
+		//READ COMMAND
+		case 0x20:
+		case 0x21:
+		case 0x22:
+		case 0x23:
+		case 0x24:
+		case 0x25:
+		case 0x26:
+		case 0x27:					
+					if ((SPDR & ONEWIRE_SPI_READ_MASK) == ONEWIRE_SPI_READ_MASK) spi_1wire_data = (spi_1wire_data >> 1) | 0x80;
+					else spi_1wire_data = (spi_1wire_data >> 1) & 0x7F;
+					if (spi_1wire_command != 0x27)
+					{
+						SPDR = ONEWIRE_SPI_PATTERN_1;
+						spi_1wire_command++;
+					}
+					else
+					{
+						// bez kolejnej szczeliny po ostatnim bicie - kolidowalaby (WCOL)
+						// z pierwsza szczelina nastepnego rozkazu
+						spi_1wire_command |= SPI_1WIRE_CMD_READY;
+						SPCR &= ~(1 << SPIE);
+					}
+					break;
+				
+		case 0x40:	// wersja z liczeniem bitow
+		case 0x41:
+		case 0x42:
+		case 0x43:
+		case 0x44:
+		case 0x45:
+		case 0x46:
+		case 0x47:
+					if (spi_1wire_command != 0x47)
+					{
+						spi_1wire_data = (spi_1wire_data >> 1) & 0x7F;
+						if ((spi_1wire_data & 0x01) == 0) SPDR = ONEWIRE_SPI_PATTERN_0;
+						else SPDR = ONEWIRE_SPI_PATTERN_1;
+						spi_1wire_command++;
+					}
+					else
+					{
+						// po ostatnim bicie nie jest wysylana dodatkowa szczelina
+						// zapisu 0 (WCOL z pierwsza szczelina nastepnego rozkazu)
+						spi_1wire_command |= SPI_1WIRE_CMD_READY;
+						SPCR &= ~(1 << SPIE);
+					}
+					break;
+		
+		// STOP TRANSMISSION
+		default:	;	
+	}
+}
+
+uint8_t OneWire_ResetPresence(void)
+{
+	  spi_1wire_command = SPI_1WIRE_CMD_RESETPULSE;
+	  SPCR |= (1 << SPIE);
+	  SPDR = ONEWIRE_SPI_PATTERN_0;
+	  while((spi_1wire_command & SPI_1WIRE_CMD_READY) == 0);
+	  return spi_1wire_data;
+}
+
+void OneWire_Write(uint8_t byte)
+{
+  spi_1wire_data = byte;
+  spi_1wire_command = SPI_1WIRE_CMD_WRITE;
+  SPCR |= (1 << SPIE);
+  if ((spi_1wire_data & 0x01) == 0x00) SPDR = ONEWIRE_SPI_PATTERN_0; else SPDR = ONEWIRE_SPI_PATTERN_1;
+  while((spi_1wire_command & SPI_1WIRE_CMD_READY) == 0);
+}
+
+uint8_t OneWire_Read(void)
+{
+  spi_1wire_command = SPI_1WIRE_CMD_READ;
+
+  SPCR |= (1 << SPIE);
+  SPDR = ONEWIRE_SPI_PATTERN_1;
+  while((spi_1wire_command & SPI_1WIRE_CMD_READY) == 0);
+  return spi_1wire_data;
+}
+
+#endif //ONEWIRE_BACKEND_SPI_ISR
@@ -0,0 +1,285 @@
+/*
+    Implementacja interfejsu 1Wire: programowe generowanie przebiegow,
+    opoznienia odmierzane licznikiem T0 (przerwanie od przepelnienia)
+
+    * wyprowadzenie magistrali - PORT_1Wire/PIN_1Wire w pliku main.h
+    * tryb rownolegly - do 8 niezaleznych magistral na wyprowadzeniach
+      BUS_1Wire_MASK jednego portu, sekwencje wykonywane jednoczesnie
+      (zapis maski do DDRx, jeden odczyt PINx dla wszystkich magistral)
+
+ */
+
+#include "onewire.h"
+
+#if ONEWIRE_BACKEND == ONEWIRE_BACKEND_TIMER0
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+//
+// Definicja sposobu podlaczenia ukladu DS18B20 (domyslnie PB0)
+//   Uwaga: podajemy adres portu PINx oraz numer wyprowadzenia portu
+//
+#ifndef PORT_1Wire
+#define PORT_1Wire PINB
+#define PIN_1Wire  PINB0
+#endif
+// wyprowadzenia portu PORT_1Wire wykorzystywane w trybie rownoleglym
+// (domyslnie tylko PIN_1Wire)
+#ifndef BUS_1Wire_MASK
+#define BUS_1Wire_MASK (1<<PIN_1Wire)
+#endif
+
+#define DDR_1Wire  _SFR_IO8(_SFR_IO_ADDR(PORT_1Wire)+1)
+#define OUT_1Wire  _SFR_IO8(_SFR_IO_ADDR(PORT_1Wire)+2)
+
+//
+// Makra ustawiajace stan magistral 1Wire wskazanych maska (bit na magistrale):
+//  * wysoki (poprzez rezystor polaryzujacy magistrale, wyprowadzenie portu
+//    skonfigurowane jako wejscie)
+#define SET_1Wire(mask)  DDR_1Wire &= ~(mask)
+//  * niski (przy zalozeniu, ze PORTx.y ma wpisana wartosc "0")
+#define CLR_1Wire(mask)  DDR_1Wire |= (mask)
+
+//
+// Definicje preskalera dla licznika T0
+//
+#define timer_stop             TCCR0 = 0
+#define timer_start_presc_1    TCCR0 = (0<<CS02)|(0<<CS01)|(1<<CS00)
+#define timer_start_presc_8    TCCR0 = (0<<CS02)|(1<<CS01)|(0<<CS00)
+#define timer_start_presc_64   TCCR0 = (0<<CS02)|(1<<CS01)|(1<<CS00)
+#define timer_start_presc_256  TCCR0 = (1<<CS02)|(0<<CS01)|(0<<CS00)
+#define timer_start_presc_1024 TCCR0 = (1<<CS02)|(0<<CS01)|(1<<CS00)
+
+// start licznika i natychmiastowe wywolanie przerwania
+#define timer_start {						\
+					TCNT0 = 255;			\
+					timer_start_presc_1;	\
+					}
+
+//
+// Definicje opoznien realizowanych za pomoca licznika T0
+//   Uwaga: wartosci poczatkowe licznika oraz preskaler wyznaczane sa w czasie
+//          kompilacji na podstawie F_CPU (dla 14,7456MHz np. 500us: preskaler
+//          64, TCNT0 = 255 - 115), wybierany jest najmniejszy preskaler, dla
+//          ktorego opoznienie miesci sie w 8-bitowym liczniku
+//
+// liczba taktow licznika T0 (zaokraglona) dla opoznienia us przy preskalerze presc
+#define timer_ticks(us, presc)	(((us) * (F_CPU / 100UL) + (presc) * 5000UL) / ((presc) * 10000UL))
+// najmniejszy preskaler dla opoznienia us
+#define timer_presc(us)		((timer_ticks(us, 1) <= 255) ? 1 :		\
+							 (timer_ticks(us, 8) <= 255) ? 8 :		\
+							 (timer_ticks(us, 64) <= 255) ? 64 :	\
+							 (timer_ticks(us, 256) <= 255) ? 256 : 1024)
+// bity CS02:CS00 rejestru TCCR0 dla preskalera presc
+#define timer_cs(presc)		(((presc) == 1) ? (1<<CS00) :					\
+							 ((presc) == 8) ? (1<<CS01) :					\
+							 ((presc) == 64) ? ((1<<CS01)|(1<<CS00)) :		\
+							 ((presc) == 256) ? (1<<CS02) : ((1<<CS02)|(1<<CS00)))
+
+#define delay_1Wire(us)  {														\
+							TCNT0 = 255 - timer_ticks(us, timer_presc(us)); 	\
+							TCCR0 = timer_cs(timer_presc(us));					\
+						 }
+
+#define delay500us_1Wire delay_1Wire(500)
+#define delay30us_1Wire  delay_1Wire(30)
+#define delay470us_1Wire delay_1Wire(470)
+#define delay2us_1Wire   delay_1Wire(2)
+#define delay15us_1Wire  delay_1Wire(15)
+#define delay5us_1Wire   delay_1Wire(5)
+#define delay80us_1Wire  delay_1Wire(80)
+
+#define delay480us_1Wire delay_1Wire(480)
+#define delay390us_1Wire delay_1Wire(390)
+#define delay90us_1Wire  delay_1Wire(90)
+#define delay60us_1Wire  delay_1Wire(60)
+#define delay45us_1Wire  delay_1Wire(45)
+#define delay14us_1Wire  delay_1Wire(14)
+#define delay1us_1Wire   delay_1Wire(1)
+
+//
+// Kontrola wymagan czasowych dla F_CPU
+//   Uwaga: czas obslugi przerwania (wejscie, zatrzymanie licznika, wybor stanu,
+//          zmiana stanu magistrali wg maski) wydluza kazde opoznienie o ok. 52 takty
+//
+#define timer_isr_cycles	52
+// czas obslugi przerwania w us (zaokraglony w gore)
+#define timer_isr_us		((timer_isr_cycles * 1000000UL + F_CPU - 1) / F_CPU)
+
+#if timer_ticks(500, 1024) > 255
+#error "F_CPU zbyt duza: opoznienie 500us przekracza zakres licznika T0"
+#endif
+#if timer_ticks(1, 1) == 0
+#error "F_CPU zbyt mala: opoznienie 1us krotsze niz takt licznika T0"
+#endif
+// impuls zapisu 1 (tLOW1 <= 15us)
+#if (5 + timer_isr_us) > 15
+#error "F_CPU zbyt mala: impuls zapisu 1 dluzszy niz 15us"
+#endif
+// impuls szczeliny odczytu (tRL) i zwolnienie magistrali przed probkowaniem
+#if (2 + timer_isr_us) >= 15
+#error "F_CPU zbyt mala: impuls odczytu nie konczy sie przed probkowaniem"
+#endif
+
+//
+// Podstawowe operacje na interfejsie 1Wire
+//
+#define cmd_1Wire_ResetPulse		0x00
+#define cmd_1Wire_ReadBit			0x04
+#define cmd_1Wire_WriteBit			0x08
+#define cmd_1Wire_Ready				0x0F
+
+//
+// Zmienna wykorzystana do obslugi interfejsu 1Wire
+//   Uwaga: najmniej znaczace bity okreslaja kod (stan poczatkowy automatu)
+//          realizowanej operacji, po jej wykonaniu przyjmuja wartosc 0x0F
+//
+static volatile unsigned char cmd_1Wire;
+//
+// Magistrale biezacej operacji oraz jej parametr/wynik (bit na magistrale,
+// pozycja bitu jak w porcie PORT_1Wire):
+//          * cmd_1Wire_ResetPulse - 1 - uklad obecny na magistrali
+//          * cmd_1Wire_ReadBit    - odczytany bit z magistrali
+//          * cmd_1Wire_WriteBit   - zapisywany bit do ukladu
+//
+static volatile uint8_t bus_1Wire;
+static volatile uint8_t data_1Wire;
+
+ISR(TIMER0_OVF_vect)
+{
+	timer_stop;
+	switch(cmd_1Wire & 0x0F)
+	{
+		// cmd_1Wire_ResetPulse
+		case 0x00: 	CLR_1Wire(bus_1Wire);
+					delay480us_1Wire;
+					cmd_1Wire++;
+					break;
+		case 0x01: 	SET_1Wire(bus_1Wire);
+					delay90us_1Wire;
+					cmd_1Wire++;
+					break;
+		case 0x02: 	data_1Wire = ~PORT_1Wire & bus_1Wire;
+					delay390us_1Wire;
+					cmd_1Wire++;
+					break;
+		case 0x03: 	cmd_1Wire |= cmd_1Wire_Ready;
+					break;
+		// cmd_1Wire_ReadBit
+		case 0x04: 	CLR_1Wire(bus_1Wire);
+					delay2us_1Wire;//bylo 1us
+					cmd_1Wire++;
+					break;
+		case 0x05: 	SET_1Wire(bus_1Wire);
+					delay15us_1Wire;//bylo 14us
+					cmd_1Wire++;
+					break;
+		case 0x06: 	data_1Wire = PORT_1Wire & bus_1Wire;
+					delay45us_1Wire;
+					cmd_1Wire++;
+					break;
+		case 0x07:	cmd_1Wire |= cmd_1Wire_Ready;
+					break;
+		// cmd_1Wire_WriteBit
+		case 0x08: 	CLR_1Wire(bus_1Wire);
+					delay5us_1Wire;//bylo 1us
+					cmd_1Wire++;
+					break;
+		case 0x09: 	SET_1Wire(data_1Wire);
+					delay90us_1Wire;//bylo 60us
+					cmd_1Wire++;
+					break;
+		case 0x0A: 	SET_1Wire(bus_1Wire);
+					cmd_1Wire |= cmd_1Wire_Ready;
+					break;
+		// cmd_1Wire_Ready
+		case 0x0F:	break;
+	}
+}
+
+// wykonanie operacji na magistralach bus, wynik w data_1Wire
+static uint8_t exec_1Wire(uint8_t cmd, uint8_t bus, uint8_t data)
+{
+	bus_1Wire = bus;
+	// bity zapisu ograniczone do wybranych magistral
+	data_1Wire = data & bus;
+	cmd_1Wire = cmd;
+	// rozpoczecie wykonywania komendy
+	timer_start;
+	// oczekiwanie na zakonczenie
+	while((cmd_1Wire & 0x0F) != cmd_1Wire_Ready);
+	return data_1Wire;
+}
+
+uint8_t OneWire_Read(void)
+{
+	uint8_t tmp = 0;
+	
+	for (unsigned char i=0; i<8; i++)
+	  {
+		// odczyt pojedynczego bitu
+		if (exec_1Wire(cmd_1Wire_ReadBit, (1<<PIN_1Wire), 0) != 0) tmp |= (1<<i);
+	  }
+	return tmp;
+}
+
+void OneWire_Write(uint8_t byte)
+{
+	for (unsigned char i=0; i<8; i++)
+	  {
+		// zapis pojedynczego bitu
+		exec_1Wire(cmd_1Wire_WriteBit, (1<<PIN_1Wire), ((byte & (1<<i)) != 0) ? 0xFF : 0);
+	  }
+}
+
+uint8_t OneWire_ResetPresence(void)
+{
+	// sprawdzenie wyniku - obecnosci ukladu na magistrali
+	if (exec_1Wire(cmd_1Wire_ResetPulse, (1<<PIN_1Wire), 0) != 0) return 1;
+	else return ONEWIRE_NO_PRESENCE;
+}
+
+uint8_t OneWire_ResetPresenceParallel(void)
+{
+	return exec_1Wire(cmd_1Wire_ResetPulse, BUS_1Wire_MASK, 0);
+}
+
+void OneWire_WriteParallel(uint8_t bus, const uint8_t *bytes)
+{
+	for (uint8_t i = 0; i < 8; i++)
+	  {
+		// bit i kazdego bajtu na pozycje magistrali (transpozycja),
+		// wyznaczany pomiedzy szczelinami - wydluza czas odpoczynku magistrali
+		uint8_t data = 0;
+
+		for (uint8_t ch = 0; ch < 8; ch++)
+			if ((bytes[ch] & (1<<i)) != 0) data |= (1<<ch);
+		exec_1Wire(cmd_1Wire_WriteBit, bus & BUS_1Wire_MASK, data);
+	  }
+}
+
+void OneWire_ReadParallel(uint8_t bus, uint8_t *bytes)
+{
+	for (uint8_t ch = 0; ch < 8; ch++) bytes[ch] = 0;
+	for (uint8_t i = 0; i < 8; i++)
+	  {
+		uint8_t data = exec_1Wire(cmd_1Wire_ReadBit, bus & BUS_1Wire_MASK, 0);
+
+		for (uint8_t ch = 0; ch < 8; ch++)
+			if ((data & (1<<ch)) != 0) bytes[ch] |= (1<<i);
+	  }
+}
+
+void OneWire_Init(void)
+{
+	// inicjalizacja licznika Timer0 i przerwania
+	// przerwanie przy przepelnieniu
+	TIMSK |= (1<<TOIE0);
+	timer_stop;
+	// wszystkie magistrale zwolnione (wejscia), PORTx.y = 0 dla CLR_1Wire
+	SET_1Wire(BUS_1Wire_MASK | (1<<PIN_1Wire));
+	OUT_1Wire &= ~(BUS_1Wire_MASK | (1<<PIN_1Wire));
+}
+
+#endif //ONEWIRE_BACKEND_TIMER0